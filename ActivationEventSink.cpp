@@ -0,0 +1,33 @@
+#include "ActivationEventSink.h"
+#include <iostream>
+
+ConsoleEventSink::ConsoleEventSink(std::ostream& out) : m_out(out) {}
+
+void ConsoleEventSink::onNodeActivated(const ActivationEvent& event) {
+    const Node& node = *event.node;
+    m_out << "Node " << node.id << " (" << node.name << ") activated at time " << event.timestamp_ms << "ms";
+    m_out << " (" << *event.source_name << ": " << event.value << comparisonOpSymbol(event.record->comparison)
+          << event.record->threshold << ").\n";
+}
+
+void ConsoleEventSink::onFaultInjected(const FaultInjectionEvent& event) {
+    m_out << "FAULT INJECTED: " << *event.parameter_id << " activated at time " << event.timestamp_ms << "ms.\n";
+}
+
+ConsoleEventSink& ConsoleEventSink::standardOutput() {
+    // Holds a reference to the std::cout object, so a redirected rdbuf (log file) is honored.
+    static ConsoleEventSink sink(std::cout);
+    return sink;
+}
+
+BufferedEventSink::BufferedEventSink(size_t reserve) {
+    m_records.reserve(reserve);
+}
+
+void BufferedEventSink::onNodeActivated(const ActivationEvent& event) {
+    m_records.push_back({Kind::NodeActivated, event.node_index, event.timestamp_ms, event.value, event.robustness});
+}
+
+void BufferedEventSink::onFaultInjected(const FaultInjectionEvent& event) {
+    m_records.push_back({Kind::FaultInjected, event.node_index, event.timestamp_ms, event.value, 0.0});
+}
\ No newline at end of file
@@ -0,0 +1,102 @@
+#ifndef ACTIVATION_EVENT_SINK_H
+#define ACTIVATION_EVENT_SINK_H
+
+/**
+ * @class ActivationEventSink
+ * @brief Receives the structured node activation events produced by the LogicEngine.
+ *
+ * The engine reports every discrepancy activation and fault injection through a sink instead of
+ * writing to std::cout, so reasoning latency is decoupled from terminal or file I/O and the engine
+ * can be embedded. Events reference engine/model-owned data and are only valid during the callback.
+ */
+
+#include "rTFPGModel.h"
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/// A discrepancy node became active because its predicate was satisfied (REQ-ENG-01).
+struct ActivationEvent {
+    size_t node_index;              ///< Dense index of the node in rTFPGModel::getNodes()
+    const Node* node;               ///< The activated node's ID and name
+    const NodeRecord* record;       ///< The activated node's predicate (has_predicate is always set)
+    const std::string* source_name; ///< External name of the signal that satisfied the predicate
+    uint64_t timestamp_ms;          ///< Timestamp of the triggering sample
+    double value;                   ///< Signal value of the triggering sample
+    double robustness;              ///< REQ-ENG-03: Robustness degree at activation
+};
+
+/// A fault injection sample activated a failure mode (FR-02.2).
+struct FaultInjectionEvent {
+    size_t node_index;               ///< Dense index of the injected node in rTFPGModel::getNodes()
+    const std::string* parameter_id; ///< The parameter ID as it appeared in the sample
+    uint64_t timestamp_ms;
+    double value;
+};
+
+class ActivationEventSink {
+public:
+    virtual ~ActivationEventSink() = default;
+
+    virtual void onNodeActivated(const ActivationEvent& event) = 0;
+    virtual void onFaultInjected(const FaultInjectionEvent& event) = 0;
+};
+
+/**
+ * @brief Default sink: formats events as the "Node ... activated" / "FAULT INJECTED" report lines.
+ */
+class ConsoleEventSink : public ActivationEventSink {
+public:
+    explicit ConsoleEventSink(std::ostream& out);
+
+    void onNodeActivated(const ActivationEvent& event) override;
+    void onFaultInjected(const FaultInjectionEvent& event) override;
+
+    /// @brief The process-wide sink writing to std::cout, used by engines without an explicit sink.
+    static ConsoleEventSink& standardOutput();
+
+private:
+    std::ostream& m_out;
+};
+
+/**
+ * @brief Discards all events. Used by benchmarks and batch evaluations that only read node states.
+ */
+class NullEventSink : public ActivationEventSink {
+public:
+    void onNodeActivated(const ActivationEvent&) override {}
+    void onFaultInjected(const FaultInjectionEvent&) override {}
+};
+
+/**
+ * @brief Records events as plain records without any formatting.
+ * @note Not synchronized; drain it from the thread that drives the engine.
+ */
+class BufferedEventSink : public ActivationEventSink {
+public:
+    enum class Kind { NodeActivated, FaultInjected };
+
+    struct Record {
+        Kind kind;
+        size_t node_index;
+        uint64_t timestamp_ms;
+        double value;
+        double robustness; // 0.0 for fault injections
+    };
+
+    /// @param reserve Number of records to preallocate so recording does not allocate.
+    explicit BufferedEventSink(size_t reserve = 0);
+
+    void onNodeActivated(const ActivationEvent& event) override;
+    void onFaultInjected(const FaultInjectionEvent& event) override;
+
+    const std::vector<Record>& getRecords() const { return m_records; }
+    /// @brief Forgets the recorded events but keeps the capacity.
+    void clear() { m_records.clear(); }
+
+private:
+    std::vector<Record> m_records;
+};
+
+#endif // ACTIVATION_EVENT_SINK_H
\ No newline at end of file
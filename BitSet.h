@@ -0,0 +1,90 @@
+#ifndef BIT_SET_H
+#define BIT_SET_H
+
+/**
+ * @class BitSet
+ * @brief Fixed-size bit set over dense indices, stored as 64-bit words.
+ *
+ * Used for word-parallel set algebra on node sets (e.g. expected vs. active symptoms), where
+ * intersections reduce to AND + popcount over a handful of words.
+ */
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+class BitSet {
+public:
+    BitSet() = default;
+    explicit BitSet(size_t bit_count) : m_bit_count(bit_count), m_words((bit_count + 63) / 64, 0) {}
+
+    size_t size() const { return m_bit_count; }
+
+    void set(size_t i) { m_words[i >> 6] |= (uint64_t{1} << (i & 63)); }
+    void reset(size_t i) { m_words[i >> 6] &= ~(uint64_t{1} << (i & 63)); }
+    bool test(size_t i) const { return (m_words[i >> 6] >> (i & 63)) & 1u; }
+    void clear() { std::fill(m_words.begin(), m_words.end(), 0); }
+
+    /// @brief Number of set bits.
+    size_t count() const {
+        size_t total = 0;
+        for (uint64_t word : m_words) total += popcount(word);
+        return total;
+    }
+
+    /// @brief |a & b| without materializing the intersection. Both sets must have the same size.
+    static size_t countAnd(const BitSet& a, const BitSet& b) {
+        size_t total = 0;
+        for (size_t w = 0; w < a.m_words.size(); ++w) total += popcount(a.m_words[w] & b.m_words[w]);
+        return total;
+    }
+
+    /// @brief Calls f(index) for every set bit, in ascending order.
+    template <typename F>
+    void forEach(F&& f) const {
+        for (size_t w = 0; w < m_words.size(); ++w) {
+            for (uint64_t word = m_words[w]; word != 0; word &= word - 1) {
+                f(w * 64 + countTrailingZeros(word));
+            }
+        }
+    }
+
+    BitSet& operator|=(const BitSet& other) {
+        for (size_t w = 0; w < m_words.size(); ++w) m_words[w] |= other.m_words[w];
+        return *this;
+    }
+
+    bool operator==(const BitSet& other) const { return m_bit_count == other.m_bit_count && m_words == other.m_words; }
+    bool operator!=(const BitSet& other) const { return !(*this == other); }
+
+    const std::vector<uint64_t>& words() const { return m_words; }
+
+private:
+    size_t m_bit_count = 0;
+    std::vector<uint64_t> m_words;
+
+    static size_t popcount(uint64_t word) {
+#if defined(_MSC_VER)
+        return static_cast<size_t>(__popcnt64(word));
+#else
+        return static_cast<size_t>(__builtin_popcountll(word));
+#endif
+    }
+
+    static size_t countTrailingZeros(uint64_t word) {
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanForward64(&index, word);
+        return static_cast<size_t>(index);
+#else
+        return static_cast<size_t>(__builtin_ctzll(word));
+#endif
+    }
+};
+
+#endif // BIT_SET_H
\ No newline at end of file
@@ -0,0 +1,160 @@
+#include "CompiledGraph.h"
+#include <algorithm>
+#include <utility>
+
+CompiledGraph::CompiledGraph(size_t node_count, const std::vector<IndexedEdge>& edges)
+    : m_node_count(node_count) {
+    build(m_forward, node_count, edges, false);
+    build(m_reverse, node_count, edges, true);
+    condense();
+    partition();
+}
+
+// Counting sort of the edges by source (forward) or target (reverse) node. Stable, so each node's
+// edges stay in model order.
+void CompiledGraph::build(Csr& csr, size_t node_count, const std::vector<IndexedEdge>& edges, bool reverse) {
+    csr.offsets.assign(node_count + 1, 0);
+    for (const IndexedEdge& edge : edges) {
+        csr.offsets[(reverse ? edge.to : edge.from) + 1]++;
+    }
+    for (size_t i = 0; i < node_count; ++i) {
+        csr.offsets[i + 1] += csr.offsets[i];
+    }
+
+    csr.neighbors.resize(edges.size());
+    csr.time_min_ms.resize(edges.size());
+    csr.time_max_ms.resize(edges.size());
+    std::vector<uint32_t> next(csr.offsets.begin(), csr.offsets.end() - 1);
+    for (const IndexedEdge& edge : edges) {
+        uint32_t pos = next[reverse ? edge.to : edge.from]++;
+        csr.neighbors[pos] = static_cast<uint32_t>(reverse ? edge.from : edge.to);
+        csr.time_min_ms[pos] = edge.time_min_ms;
+        csr.time_max_ms[pos] = edge.time_max_ms;
+    }
+}
+
+// Tarjan's strongly connected components with an explicit call stack, so deep chains cannot overflow
+// the native stack. Tarjan emits components sinks first, i.e. in reverse topological order.
+void CompiledGraph::condense() {
+    const uint32_t kUnvisited = UINT32_MAX;
+    const size_t node_count = m_node_count;
+    std::vector<uint32_t> discovery(node_count, kUnvisited);
+    std::vector<uint32_t> low(node_count, 0);
+    std::vector<char> on_stack(node_count, 0);
+    std::vector<uint32_t> stack;
+    std::vector<std::pair<uint32_t, uint32_t>> calls; // {node, next position in m_forward.neighbors}
+    std::vector<uint32_t> emitted;                      // Nodes in emission order
+    std::vector<uint32_t> emitted_ends;                 // End of each emitted component in `emitted`
+    uint32_t next_discovery = 0;
+
+    auto visit = [&](uint32_t node) {
+        discovery[node] = low[node] = next_discovery++;
+        stack.push_back(node);
+        on_stack[node] = 1;
+        calls.push_back({node, m_forward.offsets[node]});
+    };
+
+    for (uint32_t root = 0; root < node_count; ++root) {
+        if (discovery[root] != kUnvisited) continue;
+        visit(root);
+        while (!calls.empty()) {
+            uint32_t node = calls.back().first;
+            uint32_t pos = calls.back().second;
+            if (pos < m_forward.offsets[node + 1]) {
+                calls.back().second = pos + 1;
+                uint32_t child = m_forward.neighbors[pos];
+                if (discovery[child] == kUnvisited) {
+                    visit(child);
+                } else if (on_stack[child]) {
+                    low[node] = std::min(low[node], discovery[child]);
+                }
+                continue;
+            }
+
+            calls.pop_back();
+            if (!calls.empty()) {
+                uint32_t parent = calls.back().first;
+                low[parent] = std::min(low[parent], low[node]);
+            }
+            if (low[node] == discovery[node]) {
+                uint32_t member;
+                do {
+                    member = stack.back();
+                    stack.pop_back();
+                    on_stack[member] = 0;
+                    emitted.push_back(member);
+                } while (member != node);
+                emitted_ends.push_back(static_cast<uint32_t>(emitted.size()));
+            }
+        }
+    }
+
+    // Number the components in topological order and lay out their members in node order.
+    const size_t component_count = emitted_ends.size();
+    m_component.assign(node_count, 0);
+    m_topological_order.clear();
+    m_topological_order.reserve(node_count);
+    m_component_offsets.assign(1, 0);
+    m_acyclic = component_count == node_count;
+    for (size_t c = 0; c < component_count; ++c) {
+        size_t emitted_index = component_count - 1 - c;
+        auto first = emitted.begin() + (emitted_index == 0 ? 0 : emitted_ends[emitted_index - 1]);
+        auto last = emitted.begin() + emitted_ends[emitted_index];
+        std::sort(first, last);
+        for (auto it = first; it != last; ++it) {
+            m_component[*it] = static_cast<uint32_t>(c);
+            m_topological_order.push_back(*it);
+        }
+        m_component_offsets.push_back(static_cast<uint32_t>(m_topological_order.size()));
+    }
+    for (size_t node = 0; node < node_count && m_acyclic; ++node) {
+        for (uint32_t pos = m_forward.offsets[node]; pos < m_forward.offsets[node + 1]; ++pos) {
+            if (m_forward.neighbors[pos] == node) m_acyclic = false; // Self-loop
+        }
+    }
+}
+
+int CompiledGraph::maxPropagationDelay() const {
+    const auto& delays = m_forward.time_max_ms;
+    return delays.empty() ? 0 : std::max(0, *std::max_element(delays.begin(), delays.end()));
+}
+
+// Weakly connected components by breadth-first search over both edge directions, seeded in node
+// order. The members are then laid out per partition in topological order (a stable counting sort).
+void CompiledGraph::partition() {
+    const uint32_t kUnassigned = UINT32_MAX;
+    const size_t node_count = m_node_count;
+    m_partition.assign(node_count, kUnassigned);
+    uint32_t partition_count = 0;
+    std::vector<uint32_t> queue;
+    for (uint32_t seed = 0; seed < node_count; ++seed) {
+        if (m_partition[seed] != kUnassigned) continue;
+        m_partition[seed] = partition_count;
+        queue.assign(1, seed);
+        for (size_t head = 0; head < queue.size(); ++head) {
+            uint32_t node = queue[head];
+            for (const Csr* csr : {&m_forward, &m_reverse}) {
+                for (uint32_t pos = csr->offsets[node]; pos < csr->offsets[node + 1]; ++pos) {
+                    uint32_t neighbor = csr->neighbors[pos];
+                    if (m_partition[neighbor] != kUnassigned) continue;
+                    m_partition[neighbor] = partition_count;
+                    queue.push_back(neighbor);
+                }
+            }
+        }
+        ++partition_count;
+    }
+
+    m_partition_offsets.assign(partition_count + size_t{1}, 0);
+    for (uint32_t node = 0; node < node_count; ++node) {
+        m_partition_offsets[m_partition[node] + 1]++;
+    }
+    for (uint32_t p = 0; p < partition_count; ++p) {
+        m_partition_offsets[p + 1] += m_partition_offsets[p];
+    }
+    m_partition_order.resize(node_count);
+    std::vector<uint32_t> next(m_partition_offsets.begin(), m_partition_offsets.end() - 1);
+    for (uint32_t node : m_topological_order) {
+        m_partition_order[next[m_partition[node]]++] = node;
+    }
+}
@@ -0,0 +1,154 @@
+#ifndef COMPILED_GRAPH_H
+#define COMPILED_GRAPH_H
+
+/**
+ * @class CompiledGraph
+ * @brief Immutable compressed-sparse-row (CSR) form of the rTFPG edge set (REQ-MOD-01).
+ *
+ * Nodes are addressed by their dense node index (position in rTFPGModel::getNodes()). Both the
+ * forward (children) and reverse (parents) adjacency are stored as an offsets array plus parallel
+ * neighbor / time_min_ms / time_max_ms arrays, so iterating the neighbors of a node is a contiguous
+ * scan. Within a node, edges keep the order in which they appear in the model.
+ *
+ * Construction also condenses the graph into its strongly connected components (Tarjan, iterative)
+ * and orders the nodes topologically by component, so traversals that only need "parents before
+ * children" can run as a single forward pass instead of a search. It also splits the nodes into
+ * partitions, the weakly connected components: no edge joins two partitions, so they can be
+ * reasoned about independently.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// An edge with both endpoints resolved to dense node indices.
+struct IndexedEdge {
+    size_t from;
+    size_t to;
+    int time_min_ms;
+    int time_max_ms;
+};
+
+class CompiledGraph {
+public:
+    // An edge as seen from one endpoint.
+    struct AdjacentEdge {
+        size_t node_index; // The node at the other end of the edge
+        int time_min_ms;
+        int time_max_ms;
+    };
+
+private:
+    struct Csr {
+        std::vector<uint32_t> offsets;   // node_count + 1 entries
+        std::vector<uint32_t> neighbors;
+        std::vector<int> time_min_ms;
+        std::vector<int> time_max_ms;
+    };
+
+public:
+    /// @brief The edges of one node in one direction.
+    class EdgeRange {
+    public:
+        class iterator {
+        public:
+            iterator(const Csr* csr, size_t pos) : m_csr(csr), m_pos(pos) {}
+            AdjacentEdge operator*() const {
+                return {m_csr->neighbors[m_pos], m_csr->time_min_ms[m_pos], m_csr->time_max_ms[m_pos]};
+            }
+            iterator& operator++() { ++m_pos; return *this; }
+            bool operator==(const iterator& other) const { return m_pos == other.m_pos; }
+            bool operator!=(const iterator& other) const { return m_pos != other.m_pos; }
+
+        private:
+            const Csr* m_csr;
+            size_t m_pos;
+        };
+
+        EdgeRange(const Csr* csr, size_t begin, size_t end) : m_csr(csr), m_begin(begin), m_end(end) {}
+
+        iterator begin() const { return {m_csr, m_begin}; }
+        iterator end() const { return {m_csr, m_end}; }
+        size_t size() const { return m_end - m_begin; }
+        bool empty() const { return m_begin == m_end; }
+        AdjacentEdge operator[](size_t i) const { return *iterator(m_csr, m_begin + i); }
+
+    private:
+        const Csr* m_csr;
+        size_t m_begin;
+        size_t m_end;
+    };
+
+    /// @brief A run of node indices (the members of a component or partition).
+    class NodeRange {
+    public:
+        NodeRange(const uint32_t* begin, const uint32_t* end) : m_begin(begin), m_end(end) {}
+        const uint32_t* begin() const { return m_begin; }
+        const uint32_t* end() const { return m_end; }
+        size_t size() const { return static_cast<size_t>(m_end - m_begin); }
+
+    private:
+        const uint32_t* m_begin;
+        const uint32_t* m_end;
+    };
+
+    CompiledGraph() = default;
+    CompiledGraph(size_t node_count, const std::vector<IndexedEdge>& edges);
+
+    size_t nodeCount() const { return m_node_count; }
+    size_t edgeCount() const { return m_forward.neighbors.size(); }
+    /// @brief Largest time_max_ms of any edge (0 without edges): how far back a propagation check can look.
+    int maxPropagationDelay() const;
+
+    /// @brief Outgoing edges of a node (the nodes it propagates to).
+    EdgeRange children(size_t node_index) const { return range(m_forward, node_index); }
+    /// @brief Incoming edges of a node (the nodes that propagate to it).
+    EdgeRange parents(size_t node_index) const { return range(m_reverse, node_index); }
+
+    /**
+     * @brief Strongly connected component of a node. Components are numbered in topological order of
+     *        the condensation: every edge between two components goes to a higher-numbered one.
+     */
+    size_t componentOf(size_t node_index) const { return m_component[node_index]; }
+    size_t componentCount() const { return m_component_offsets.size() - 1; }
+    NodeRange componentMembers(size_t component) const {
+        return {m_topological_order.data() + m_component_offsets[component],
+                m_topological_order.data() + m_component_offsets[component + 1]};
+    }
+    /// @brief All node indices, component by component in topological order.
+    const std::vector<uint32_t>& topologicalOrder() const { return m_topological_order; }
+    /// @brief True if the graph has no cycle (no component of several nodes, no self-loop).
+    bool isAcyclic() const { return m_acyclic; }
+
+    /// @brief Weakly connected component of a node. Partitions are numbered by their lowest node index.
+    size_t partitionOf(size_t node_index) const { return m_partition[node_index]; }
+    size_t partitionCount() const { return m_partition_offsets.size() - 1; }
+    /// @brief The nodes of a partition, in topological order (as in topologicalOrder()).
+    NodeRange partitionMembers(size_t partition) const {
+        return {m_partition_order.data() + m_partition_offsets[partition],
+                m_partition_order.data() + m_partition_offsets[partition + 1]};
+    }
+
+private:
+    friend class ModelSnapshot; // Serializes the CSR arrays; on load, derives the components from them
+
+    size_t m_node_count = 0;
+    Csr m_forward;
+    Csr m_reverse;
+    std::vector<uint32_t> m_component;                  // Node index -> component
+    std::vector<uint32_t> m_topological_order;          // Node indices grouped by component
+    std::vector<uint32_t> m_component_offsets = {0};    // Component -> start in m_topological_order
+    bool m_acyclic = true;
+    std::vector<uint32_t> m_partition;                  // Node index -> partition
+    std::vector<uint32_t> m_partition_order;            // Node indices grouped by partition
+    std::vector<uint32_t> m_partition_offsets = {0};    // Partition -> start in m_partition_order
+
+    static EdgeRange range(const Csr& csr, size_t node_index) {
+        return {&csr, csr.offsets[node_index], csr.offsets[node_index + 1]};
+    }
+    static void build(Csr& csr, size_t node_count, const std::vector<IndexedEdge>& edges, bool reverse);
+    void condense();
+    void partition();
+};
+
+#endif // COMPILED_GRAPH_H
@@ -0,0 +1,45 @@
+#include "CriticalityIndex.h"
+#include "rTFPGModel.h"
+#include <algorithm>
+#include <functional>
+
+CriticalityIndex::CriticalityIndex(const std::vector<NodeRecord>& nodes, const std::vector<uint32_t>& id_ranks)
+    : m_empty(nodes.size()) {
+    m_order.resize(nodes.size());
+    for (size_t i = 0; i < nodes.size(); ++i) m_order[i] = i;
+    // The ID tie-break keeps the front independent of where removals have moved nodes.
+    std::sort(m_order.begin(), m_order.end(), [&nodes, &id_ranks](size_t a, size_t b) {
+        if (nodes[a].criticality_level != nodes[b].criticality_level) {
+            return nodes[a].criticality_level > nodes[b].criticality_level;
+        }
+        return id_ranks[a] < id_ranks[b];
+    });
+
+    // Each mask extends the previous (higher) level's mask by the nodes of its own run.
+    BitSet running(nodes.size());
+    for (size_t pos = 0; pos < m_order.size(); ++pos) {
+        int level = nodes[m_order[pos]].criticality_level;
+        running.set(m_order[pos]);
+        if (pos + 1 == m_order.size() || nodes[m_order[pos + 1]].criticality_level != level) {
+            m_levels.push_back(level);
+            m_level_end.push_back(pos + 1);
+            m_masks.push_back(running);
+        }
+    }
+}
+
+size_t CriticalityIndex::levelsAtOrAbove(int n) const {
+    // m_levels is descending: count the leading entries that are >= n.
+    return static_cast<size_t>(std::upper_bound(m_levels.begin(), m_levels.end(), n, std::greater<int>()) -
+                               m_levels.begin());
+}
+
+IndexSpan CriticalityIndex::front(int n) const {
+    size_t levels = levelsAtOrAbove(n);
+    return IndexSpan(m_order.data(), levels == 0 ? 0 : m_level_end[levels - 1]);
+}
+
+const BitSet& CriticalityIndex::mask(int n) const {
+    size_t levels = levelsAtOrAbove(n);
+    return levels == 0 ? m_empty : m_masks[levels - 1];
+}
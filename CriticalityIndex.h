@@ -0,0 +1,44 @@
+#ifndef CRITICALITY_INDEX_H
+#define CRITICALITY_INDEX_H
+
+/**
+ * @class CriticalityIndex
+ * @brief Node indices ordered by criticality level, for threshold queries (REQ-MOD-04).
+ *
+ * Nodes are sorted by descending criticality_level, ties in node ID order, so the criticality front
+ * for a threshold n (all nodes with criticality_level >= n) is a prefix found by binary search.
+ * One membership bit set is kept per distinct level, so "is node i on the front for n" is O(1).
+ */
+
+#include "BitSet.h"
+#include "IndexSpan.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct NodeRecord;
+
+class CriticalityIndex {
+public:
+    CriticalityIndex() = default;
+    /// @param id_ranks Position of each node's ID in ID order (rTFPGModel::getNodeIdRanks()), for ties.
+    CriticalityIndex(const std::vector<NodeRecord>& nodes, const std::vector<uint32_t>& id_ranks);
+
+    /// @brief Nodes with criticality_level >= n, most critical first. Valid until the index is rebuilt.
+    IndexSpan front(int n) const;
+
+    /// @brief Membership bit set over node indices of front(n).
+    const BitSet& mask(int n) const;
+
+private:
+    std::vector<size_t> m_order;       // Node indices, by descending criticality
+    std::vector<int> m_levels;         // Distinct levels, descending
+    std::vector<size_t> m_level_end;   // Per distinct level: end of its run in m_order
+    std::vector<BitSet> m_masks;       // Per distinct level: nodes at that level or above
+    BitSet m_empty;                    // Returned for thresholds above every level
+
+    // Number of distinct levels >= n.
+    size_t levelsAtOrAbove(int n) const;
+};
+
+#endif // CRITICALITY_INDEX_H
@@ -0,0 +1,52 @@
+#include "DataStreamReader.h"
+#include "JsonSectionSax.h"
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace {
+
+using json = nlohmann::json;
+
+// Delivers the "data_stream" elements and keeps "scenario_id"; all other root members are skipped.
+class DataStreamSaxHandler : public JsonSectionSax {
+public:
+    DataStreamSaxHandler(const DataStreamReader::StartHandler& on_start, const DataStreamReader::EventHandler& on_event)
+        : m_on_start(on_start), m_on_event(on_event) {}
+
+    // Fires on_start if no "data_stream" array did.
+    void start() {
+        if (m_started) return;
+        m_started = true;
+        m_on_start(m_scenario_id);
+    }
+
+protected:
+    Member memberFor(const std::string& key) override {
+        if (key == "data_stream") return Member::Section;
+        if (key != "scenario_id") return Member::Skip;
+        // Events already processed were reported under the ID on_start saw; a later one would be ignored.
+        if (m_started) {
+            throw std::invalid_argument("\"scenario_id\" must come before \"data_stream\" in the test data.");
+        }
+        return Member::Value;
+    }
+
+    void onSectionStart() override { start(); }
+    void onElement(json& element) override { m_on_event(element); }
+    void onValue(json& value) override { m_scenario_id = std::move(value); }
+
+private:
+    const DataStreamReader::StartHandler& m_on_start;
+    const DataStreamReader::EventHandler& m_on_event;
+    bool m_started = false;
+    json m_scenario_id;
+};
+
+} // namespace
+
+void DataStreamReader::read(std::istream& input, const StartHandler& on_start, const EventHandler& on_event) {
+    DataStreamSaxHandler handler(on_start, on_event);
+    json::sax_parse(input, &handler);
+    handler.start();
+}
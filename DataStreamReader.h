@@ -0,0 +1,35 @@
+#ifndef DATA_STREAM_READER_H
+#define DATA_STREAM_READER_H
+
+/**
+ * @class DataStreamReader
+ * @brief Streaming (SAX) reader for JSON test data.
+ *
+ * Hands each element of the root "data_stream" array to a callback as soon as the parser has read
+ * it, without materializing the document, so a replay holds one event at a time however long the
+ * stream is. The "scenario_id" member is kept; all other top-level members are skipped as they
+ * stream past.
+ *
+ * Unlike a parsed document, where a repeated key replaces the earlier member, every "data_stream"
+ * array is delivered, in file order. on_start runs before the first event, so "scenario_id" must
+ * precede "data_stream"; a file where it follows is rejected with std::invalid_argument rather than
+ * reported without its ID. Syntax errors surface as nlohmann::json::parse_error. Both are only
+ * thrown once the parser reaches them, i.e. after the events before them have been delivered.
+ */
+
+#include "json.hpp"
+#include <functional>
+#include <istream>
+
+class DataStreamReader {
+public:
+    /// Called once, before the first event (or at the end if there is none), with the scenario ID or null.
+    using StartHandler = std::function<void(const nlohmann::json& scenario_id)>;
+    /// Called for each element of "data_stream", in file order.
+    using EventHandler = std::function<void(const nlohmann::json& event)>;
+
+    /// @throws nlohmann::json::exception and std::invalid_argument as described above, and whatever the handlers throw.
+    static void read(std::istream& input, const StartHandler& on_start, const EventHandler& on_event);
+};
+
+#endif // DATA_STREAM_READER_H
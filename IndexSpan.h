@@ -0,0 +1,30 @@
+#ifndef INDEX_SPAN_H
+#define INDEX_SPAN_H
+
+/**
+ * @class IndexSpan
+ * @brief Non-owning, read-only view of a contiguous run of dense node indices.
+ *
+ * Lets results refer to index lists held in a longer-lived owner (e.g. the LogicEngine's
+ * per-failure-mode symptom lists) without copying them. The owner defines how long a span stays valid.
+ */
+
+#include <cstddef>
+
+class IndexSpan {
+public:
+    IndexSpan() = default;
+    IndexSpan(const size_t* data, size_t size) : m_data(data), m_size(size) {}
+
+    const size_t* begin() const { return m_data; }
+    const size_t* end() const { return m_data + m_size; }
+    size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+    size_t operator[](size_t i) const { return m_data[i]; }
+
+private:
+    const size_t* m_data = nullptr;
+    size_t m_size = 0;
+};
+
+#endif // INDEX_SPAN_H
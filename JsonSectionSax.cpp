@@ -0,0 +1,110 @@
+#include "JsonSectionSax.h"
+#include <utility>
+
+using json = nlohmann::json;
+
+bool JsonSectionSax::null() { return value(nullptr); }
+bool JsonSectionSax::boolean(bool val) { return value(val); }
+bool JsonSectionSax::number_integer(number_integer_t val) { return value(val); }
+bool JsonSectionSax::number_unsigned(number_unsigned_t val) { return value(val); }
+bool JsonSectionSax::number_float(number_float_t val, const string_t&) { return value(val); }
+bool JsonSectionSax::string(string_t& val) { return value(std::move(val)); }
+bool JsonSectionSax::binary(binary_t& val) { return value(json::binary_t(std::move(val))); }
+
+bool JsonSectionSax::start_object(std::size_t) {
+    if (!m_stack.empty()) {
+        m_stack.push_back(insert(json::object()));
+    } else if (valueStarts()) {
+        m_value = json::object();
+        m_stack.push_back(&m_value);
+    } else if (m_depth == 0) {
+        m_root_is_object = true;
+    }
+    ++m_depth;
+    return true;
+}
+
+bool JsonSectionSax::key(string_t& val) {
+    if (!m_stack.empty()) {
+        m_key = std::move(val);
+    } else if (m_depth == 1 && m_root_is_object) {
+        m_pending = memberFor(val);
+    }
+    return true;
+}
+
+bool JsonSectionSax::end_object() { return endContainer(); }
+
+bool JsonSectionSax::start_array(std::size_t) {
+    if (!m_stack.empty()) {
+        m_stack.push_back(insert(json::array()));
+    } else if (valueStarts()) {
+        m_value = json::array();
+        m_stack.push_back(&m_value);
+    } else if (m_depth == 1 && m_root_is_object && m_pending == Member::Section) {
+        m_in_section = true;
+        onSectionStart();
+    }
+    ++m_depth;
+    return true;
+}
+
+bool JsonSectionSax::end_array() { return endContainer(); }
+
+bool JsonSectionSax::parse_error(std::size_t, const std::string&, const json::exception& ex) {
+    switch (ex.id / 100) {
+        case 1: throw static_cast<const json::parse_error&>(ex);
+        case 4: throw static_cast<const json::out_of_range&>(ex);
+        default: throw ex;
+    }
+}
+
+// True if the next value is a collected member or a direct element of an open section.
+bool JsonSectionSax::valueStarts() const {
+    return (m_depth == 1 && m_root_is_object && m_pending == Member::Value) || (m_depth == 2 && m_in_section);
+}
+
+json* JsonSectionSax::insert(json&& v) {
+    json& parent = *m_stack.back();
+    if (parent.is_object()) {
+        return &(parent[m_key] = std::move(v));
+    }
+    parent.push_back(std::move(v));
+    return &parent.back();
+}
+
+template <class T>
+bool JsonSectionSax::value(T&& v) {
+    if (!m_stack.empty()) {
+        insert(json(std::forward<T>(v)));
+    } else if (valueStarts()) {
+        // Scalar section elements are handed over too, so the subclass reports them as it would a bad object.
+        m_value = json(std::forward<T>(v));
+        dispatch();
+    }
+    return true;
+}
+
+bool JsonSectionSax::endContainer() {
+    --m_depth;
+    if (!m_stack.empty()) {
+        m_stack.pop_back();
+        if (m_stack.empty()) {
+            dispatch();
+        }
+    } else if (m_depth == 1) {
+        m_in_section = false;
+        m_pending = Member::Skip;
+    }
+    return true;
+}
+
+// m_depth is 1 for a collected value and 2 for a section element, whether it was a container or not.
+void JsonSectionSax::dispatch() {
+    if (m_depth == 1) {
+        onValue(m_value);
+    } else {
+        onElement(m_value);
+    }
+    m_value = nullptr;
+}
@@ -0,0 +1,71 @@
+#ifndef JSON_SECTION_SAX_H
+#define JSON_SECTION_SAX_H
+
+/**
+ * @class JsonSectionSax
+ * @brief SAX handler base for JSON files whose root object holds long arrays ("sections").
+ *
+ * For each root key, the subclass says whether the member is a section, a value to collect, or to
+ * be skipped. Each element of a section array is handed to onElement() as soon as the parser has
+ * read it; a collected member is handed to onValue() whole. Only the element or value currently
+ * being read is held, so memory does not grow with the length of the file. Members that are
+ * skipped, and sections whose value is not an array, are dropped as they stream past.
+ *
+ * Syntax errors are rethrown from parse_error() with their concrete type, so callers can keep
+ * catching nlohmann::json::parse_error. Exceptions thrown by the callbacks end the parse.
+ */
+
+#include "json.hpp"
+#include <cstddef>
+#include <string>
+#include <vector>
+
+class JsonSectionSax : public nlohmann::json::json_sax_t {
+public:
+    bool null() override;
+    bool boolean(bool val) override;
+    bool number_integer(number_integer_t val) override;
+    bool number_unsigned(number_unsigned_t val) override;
+    bool number_float(number_float_t val, const string_t&) override;
+    bool string(string_t& val) override;
+    bool binary(binary_t& val) override;
+
+    bool start_object(std::size_t) override;
+    bool key(string_t& val) override;
+    bool end_object() override;
+    bool start_array(std::size_t) override;
+    bool end_array() override;
+
+    bool parse_error(std::size_t, const std::string&, const nlohmann::json::exception& ex) override;
+
+protected:
+    enum class Member { Skip, Section, Value };
+
+    /// @brief Called once per root key, in file order, before its value is read.
+    virtual Member memberFor(const std::string& key) = 0;
+    /// @brief Called when the array of a section opens, before its first element.
+    virtual void onSectionStart() {}
+    /// @brief Called with each element of the open section, in file order.
+    virtual void onElement(nlohmann::json& element) = 0;
+    /// @brief Called with the complete value of a member collected with Member::Value.
+    virtual void onValue(nlohmann::json&) {}
+
+private:
+    // Depth 0 is outside the document, depth 1 inside the root object, depth 2 inside a section.
+    std::size_t m_depth = 0;
+    bool m_root_is_object = false;
+    bool m_in_section = false;               // A section array is open
+    Member m_pending = Member::Skip;         // What the current root key names
+    nlohmann::json m_value;                  // The element or value being built
+    std::vector<nlohmann::json*> m_stack;    // Open containers inside m_value
+    std::string m_key;
+
+    bool valueStarts() const;
+    nlohmann::json* insert(nlohmann::json&& v);
+    template <class T>
+    bool value(T&& v);
+    bool endContainer();
+    void dispatch();
+};
+
+#endif // JSON_SECTION_SAX_H
@@ -1,248 +1,564 @@
 #include "LogicEngine.h"
-#include <iostream> // For placeholder output
 #include <algorithm>
 #include <vector>
 #include <cmath>
 #include <map>
 #include <set>
-#include <functional>
 
 LogicEngine::LogicEngine(const rTFPGModel& model, const SignalIngestor& ingestor)
-    : m_model(model), m_ingestor(ingestor) {
+    : m_model(model), m_ingestor(ingestor), m_graph(model.getGraph()), m_id_ranks(model.getNodeIdRanks()), m_event_sink(&ConsoleEventSink::standardOutput()) {
     // Initialize node states for all nodes in the model
-    for (const auto& node : m_model.getNodes()) {
-        m_node_states[node.id] = NodeState{};
+    m_node_states.assign(m_model.getNodes().size(), NodeState{});
+    buildAncestorIndex();
+    buildFailureSignatures();
+    buildSignalDependencyIndex();
+    m_partitions.resize(m_graph.partitionCount());
+    m_bprop_marks.assign(m_node_states.size(), 0);
+}
+
+std::unordered_map<std::string, NodeState> LogicEngine::getNodeStates() const {
+    std::unordered_map<std::string, NodeState> states;
+    const auto& nodes = m_model.getNodes();
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        states.emplace(nodes[i].id, m_node_states[i]);
     }
+    return states;
 }
 
 /**
- * @brief REQ-ENG-03: Calculates the robustness for a single predicate.
- * @refinement Returns a positive value if the predicate is satisfied, negative if violated.
+ * @brief Precomputes, for every discrepancy, the failure modes that can structurally explain it.
+ * @refinement BProp only continues through discrepancy parents, so anc(d) is the union of the FM
+ *             parents of d and anc(p) for its discrepancy parents p. Walking the components of the
+ *             compiled graph in topological order, every parent outside a node's own component is
+ *             final when the node is merged; a component with a cycle is iterated until its sets stop
+ *             growing. The index is therefore exact for any graph.
  */
-double calculateRobustness(const Predicate& predicate, double signal_value, double range_min, double range_max) {
-    double raw_val = 0.0;
-    if (predicate.op == ">") {
-        raw_val = signal_value - predicate.threshold;
-    } else if (predicate.op == "<") {
-        raw_val = predicate.threshold - signal_value;
-    }
-    // Extend with other operators like ==, >=, <= as needed.
-    
-    double range = range_max - range_min;
-    if (range <= 1e-9) return raw_val; // Avoid division by zero, return raw
-    
-    return raw_val / range;
+void LogicEngine::buildAncestorIndex() {
+    const auto& nodes = m_model.getNodeRecords();
+    m_ancestor_failures.assign(nodes.size(), {});
+
+    std::vector<size_t> merged;
+    for (size_t component = 0; component < m_graph.componentCount(); ++component) {
+        const auto members = m_graph.componentMembers(component);
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            for (uint32_t current : members) {
+                if (nodes[current].type != NodeType::Discrepancy) continue;
+                auto& ancestors = m_ancestor_failures[current];
+                size_t before = ancestors.size();
+                for (const AdjacentEdge& edge : m_graph.parents(current)) {
+                    size_t parent = edge.node_index;
+                    const std::vector<size_t> single{parent};
+                    const auto& contribution = (nodes[parent].type == NodeType::FailureMode) ? single : m_ancestor_failures[parent];
+                    merged.clear();
+                    std::set_union(ancestors.begin(), ancestors.end(), contribution.begin(), contribution.end(),
+                                   std::back_inserter(merged));
+                    ancestors.swap(merged);
+                }
+                changed = changed || ancestors.size() != before;
+            }
+            if (members.size() == 1) break; // No cycle through another node; a self-loop adds nothing
+        }
+    }
+}
+
+/**
+ * @brief Precomputes the expected symptoms of every failure mode as a bitset over discrepancy ordinals.
+ * @refinement The set of discrepancies reachable from a failure mode depends only on the model, so the
+ *             FProp walk is done once here instead of on every diagnosis call.
+ */
+void LogicEngine::buildFailureSignatures() {
+    const auto& nodes = m_model.getNodeRecords();
+    m_discrepancy_ordinal.assign(nodes.size(), -1);
+    size_t discrepancy_count = 0;
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        if (nodes[i].type == NodeType::Discrepancy) {
+            m_discrepancy_ordinal[i] = static_cast<int>(discrepancy_count++);
+        }
+    }
+    m_active_discrepancies = BitSet(discrepancy_count);
+    m_candidate_scope = BitSet(discrepancy_count);
+    m_failure_signatures.assign(nodes.size(), FailureSignature{});
+
+    std::vector<size_t> queue;
+    std::vector<char> visited(nodes.size(), 0);
+    for (size_t fm = 0; fm < nodes.size(); ++fm) {
+        if (nodes[fm].type != NodeType::FailureMode) continue;
+        FailureSignature& signature = m_failure_signatures[fm];
+        signature.expected = BitSet(discrepancy_count);
+
+        // Breadth-first walk over the children of the failure mode.
+        queue.assign(1, fm);
+        visited[fm] = 1;
+        for (size_t head = 0; head < queue.size(); ++head) {
+            for (const AdjacentEdge& edge : m_graph.children(queue[head])) {
+                if (visited[edge.node_index]) continue;
+                visited[edge.node_index] = 1;
+                queue.push_back(edge.node_index);
+                if (m_discrepancy_ordinal[edge.node_index] >= 0) {
+                    signature.expected.set(static_cast<size_t>(m_discrepancy_ordinal[edge.node_index]));
+                    signature.expected_by_id.push_back(edge.node_index);
+                }
+            }
+        }
+        for (size_t n : queue) visited[n] = 0;
+
+        signature.expected_count = signature.expected_by_id.size();
+        // Report symptoms in node ID order
+        const auto& definitions = m_model.getNodes();
+        std::sort(signature.expected_by_id.begin(), signature.expected_by_id.end(),
+                  [&definitions](size_t a, size_t b) { return definitions[a].id < definitions[b].id; });
+    }
 }
 
 /**
- * @brief REQ-ENG-01: Evaluates all discrepancy node predicates against the full signal trace.
+ * @brief REQ-ENG-04 / FR-07: Backward propagation from the active symptoms to candidate failure modes.
+ * @refinement A failure mode is a candidate if it is a parent of an active symptom, or of an active
+ *             discrepancy reached through edges whose observed delay lies in [time_min_ms, time_max_ms].
+ *             The outcome of expanding a node does not depend on how it was reached, so every node is
+ *             expanded at most once, and symptoms whose ancestor failure modes are all candidates
+ *             already are skipped. Cost is O(active symptoms x ancestors).
+ * @param marks Per-node scratch flags, zero on entry and cleared again on return. BProp never leaves
+ *              the partition of its symptoms, so calls for different partitions may share it concurrently.
+ * @return Candidate failure mode indices in ascending order.
  */
-void evaluateSignalTrace(const rTFPGModel& model, const SignalIngestor& ingestor, std::unordered_map<std::string, NodeState>& node_states) {
-    // std::cout << "--- Evaluating Signal Trace ---" << std::endl;
-    // This is a simplified approach that iterates through all ingested samples.
-    // A real-time system would process samples as they arrive.
-    for (const auto& sample : ingestor.getSamples()) {
-        // Check if the sample corresponds to a fault injection or a sensor reading
-        bool is_sensor_reading = false;
-        for (const auto& signal : model.getSignals()) {
-            if (signal.source_name == sample.parameterID) {
-                is_sensor_reading = true;
-                break;
+std::vector<size_t> LogicEngine::backwardPropagate(const std::vector<size_t>& active_symptoms,
+                                                   std::vector<uint8_t>& marks) const {
+    enum : uint8_t { kCandidate = 1, kExpanded = 2 };
+    const auto& nodes = m_model.getNodeRecords();
+    std::vector<size_t> candidates;
+    std::vector<size_t> expanded_nodes;
+    std::vector<size_t> stack;
+    auto is_candidate = [&marks](size_t node) { return (marks[node] & kCandidate) != 0; };
+    auto expanded = [&marks](size_t node) { return (marks[node] & kExpanded) != 0; };
+    auto expand = [&](size_t node) {
+        marks[node] |= kExpanded;
+        expanded_nodes.push_back(node);
+        stack.push_back(node);
+    };
+
+    for (size_t symptom : active_symptoms) {
+        if (expanded(symptom)) continue;
+        const auto& ancestors = m_ancestor_failures[symptom];
+        bool explained = std::all_of(ancestors.begin(), ancestors.end(), is_candidate);
+        if (explained) continue;
+
+        expand(symptom);
+        while (!stack.empty()) {
+            size_t current = stack.back();
+            stack.pop_back();
+            for (const AdjacentEdge& edge : m_graph.parents(current)) {
+                size_t parent = edge.node_index;
+
+                if (nodes[parent].type == NodeType::FailureMode) {
+                    if (!is_candidate(parent)) {
+                        marks[parent] |= kCandidate;
+                        candidates.push_back(parent);
+                    }
+                } else if (!expanded(parent) && m_node_states[parent].is_active) {
+                    // Check consistency: Parent must be active and within time window
+                    double t_child = m_node_states[current].activation_time_ms;
+                    double t_parent = m_node_states[parent].activation_time_ms;
+                    double delta = t_child - t_parent;
+
+                    if (delta >= edge.time_min_ms && delta <= edge.time_max_ms) {
+                        expand(parent);
+                    }
+                }
             }
         }
+    }
+
+    for (size_t node : candidates) marks[node] = 0;
+    for (size_t node : expanded_nodes) marks[node] = 0;
+    std::sort(candidates.begin(), candidates.end());
+    return candidates;
+}
+
+/**
+ * @brief REQ-ENG-03: Compiles a predicate into its evaluation kernel parameters.
+ * @refinement The operator is folded into a sign and an inclusive flag, and the signal range into
+ *             its reciprocal, so evaluation needs no string comparison or division.
+ */
+LogicEngine::CompiledPredicate LogicEngine::compilePredicate(size_t node_index, const NodeRecord& predicate,
+                                                             double range_min, double range_max) {
+    double range = range_max - range_min;
+    double inverse_range = (range <= 1e-9) ? 1.0 : 1.0 / range; // Degenerate range: use the raw margin
+
+    CompiledPredicate compiled{node_index, predicate.threshold, inverse_range, false, false};
+    switch (predicate.comparison) {
+        case ComparisonOp::Greater:
+            break;
+        case ComparisonOp::GreaterEqual:
+            compiled.inclusive = true;
+            break;
+        case ComparisonOp::Less:
+            compiled.scale = -inverse_range;
+            break;
+        case ComparisonOp::LessEqual:
+            compiled.scale = -inverse_range;
+            compiled.inclusive = true;
+            break;
+        case ComparisonOp::Equal:
+            compiled.distance = true;
+            compiled.inclusive = true;
+            break;
+        case ComparisonOp::NotEqual:
+            compiled.distance = true;
+            compiled.scale = -inverse_range;
+            break;
+    }
+    return compiled;
+}
+
+/**
+ * @brief Builds the index from ingestor signal IDs to the discrepancy predicates that read them.
+ * @refinement Resolves signal_ref and the normalization range once, so a sample only visits
+ *             the predicates that depend on it. Bindings keep model node order per signal.
+ */
+void LogicEngine::buildSignalDependencyIndex() {
+    const auto& nodes = m_model.getNodeRecords();
+    m_predicate_signal.assign(nodes.size(), -1);
+    for (size_t node_index = 0; node_index < nodes.size(); ++node_index) {
+        const NodeRecord& node = nodes[node_index];
+        if (node.type != NodeType::Discrepancy || !node.has_predicate) continue;
+
+        if (node.signal_index < 0) continue; // Unresolved signal_ref never matches a sample
+        const Signal& signal = m_model.getSignals()[static_cast<size_t>(node.signal_index)];
+        int signal_id = m_ingestor.getInternalId(signal.source_name);
+        if (signal_id < 0) continue;
+
+        if (static_cast<size_t>(signal_id) >= m_signal_dependents.size()) {
+            m_signal_dependents.resize(static_cast<size_t>(signal_id) + 1);
+        }
+        m_signal_dependents[static_cast<size_t>(signal_id)].push_back(
+            compilePredicate(node_index, node, signal.range_min, signal.range_max));
+        m_predicate_signal[node_index] = signal_id;
+    }
+}
+
+// FR-06: An OR gate always passes; an AND gate needs every parent active no later than the sample.
+bool LogicEngine::isGateSatisfied(size_t node_index, uint64_t timestamp_ms) const {
+    if (m_model.getNodeRecords()[node_index].gate_type != GateType::AND) return true;
+    for (const AdjacentEdge& edge : m_graph.parents(node_index)) {
+        const NodeState& parent = m_node_states[edge.node_index];
+        if (!parent.is_active || parent.activation_time_ms > timestamp_ms) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Activation times never change once set, so a parent that activated after the sample blocks it for good.
+bool LogicEngine::isBlockedForever(size_t node_index, uint64_t timestamp_ms) const {
+    for (const AdjacentEdge& edge : m_graph.parents(node_index)) {
+        const NodeState& parent = m_node_states[edge.node_index];
+        if (parent.is_active && parent.activation_time_ms > timestamp_ms) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void LogicEngine::activateDiscrepancy(size_t node_index, uint64_t timestamp_ms, double value, double robustness) {
+    auto& state = m_node_states[node_index];
+    state.is_active = true;
+    state.robustness = robustness;
+    state.activation_time_ms = timestamp_ms;
+    state.trigger_value = value;
+    noteActivation(node_index);
+
+    const std::string& source_name = m_ingestor.getParameterId(m_predicate_signal[node_index]);
+    m_event_sink->onNodeActivated({node_index, &m_model.getNodes()[node_index], &m_model.getNodeRecords()[node_index],
+                                   &source_name, timestamp_ms, value, robustness});
+}
+
+// Bookkeeping shared by predicate activations and fault injections: only the partition of the node
+// needs its BProp candidates rebuilt.
+void LogicEngine::noteActivation(size_t node_index) {
+    m_retry_blocked = true;
+    m_candidates_dirty = true;
+    m_scores_dirty = true;
+    m_counters.activations++;
+
+    PartitionState& partition = m_partitions[m_graph.partitionOf(node_index)];
+    if (!partition.dirty) {
+        partition.dirty = true;
+        m_dirty_partitions.push_back(m_graph.partitionOf(node_index));
+    }
+    int ordinal = m_discrepancy_ordinal[node_index];
+    if (ordinal >= 0) {
+        m_active_discrepancies.set(static_cast<size_t>(ordinal));
+        partition.active_symptoms.push_back(node_index);
+    }
+}
+
+/**
+ * @brief Re-evaluates AND-gate activations that were blocked when their sample arrived.
+ * @refinement A full rescan of the trace would revisit these samples on every call; only they
+ *             can change outcome, so retrying them in the original order gives identical states.
+ */
+void LogicEngine::retryBlockedActivations() {
+    if (!m_retry_blocked || m_blocked.empty()) return;
+    m_retry_blocked = false;
+
+    size_t kept = 0;
+    for (size_t i = 0; i < m_blocked.size(); ++i) {
+        const BlockedActivation& blocked = m_blocked[i];
+        if (m_node_states[blocked.node_index].is_active) continue; // Fired earlier in this pass
+
+        if (isGateSatisfied(blocked.node_index, blocked.timestamp_ms)) {
+            activateDiscrepancy(blocked.node_index, blocked.timestamp_ms, blocked.value, blocked.robustness);
+        } else if (!isBlockedForever(blocked.node_index, blocked.timestamp_ms)) {
+            m_blocked[kept++] = blocked;
+        }
+    }
+    m_blocked.resize(kept);
+}
+
+/**
+ * @brief REQ-ENG-01: Evaluates discrepancy node predicates against the samples ingested since the last call.
+ * @param max_samples Stop after this many samples; the rest stay pending.
+ * @return The number of samples evaluated.
+ */
+size_t LogicEngine::evaluateNewSamples(size_t max_samples) {
+    const auto& nodes = m_model.getNodes();
 
-        if (is_sensor_reading) {
-            for (const auto& node : model.getNodes()) {
-                if (node.type == NodeType::Discrepancy && node.predicate) {
-                    // Inefficient lookup, a map would be better.
-                    std::string source_name_for_predicate;
-                    double range_min = 0.0;
-                    double range_max = 1.0;
-                    for (const auto& sig : model.getSignals()) {
-                        if (sig.id == node.predicate->signal_ref) {
-                            source_name_for_predicate = sig.source_name;
-                            range_min = sig.range_min;
-                            range_max = sig.range_max;
-                            break;
-                        }
+    size_t evaluated = 0;
+    IngestedSample sample;
+    while (evaluated < max_samples && m_ingestor.next(m_cursor, sample)) {
+        ++evaluated;
+        m_counters.samples_evaluated++;
+
+        // A sample is a sensor reading when its parameter maps to a model signal; otherwise
+        // it is treated as a fault injection.
+        int signal_id = sample.signal_id;
+
+        if (signal_id >= 0) {
+            if (static_cast<size_t>(signal_id) >= m_signal_dependents.size()) continue;
+            for (const CompiledPredicate& predicate : m_signal_dependents[static_cast<size_t>(signal_id)]) {
+                double robustness = predicate.robustness(sample.value);
+                auto& state = m_node_states[predicate.node_index];
+
+                // Update robustness for inactive nodes to reflect current state (e.g. negative or positive-but-blocked)
+                if (!state.is_active && state.robustness != robustness) {
+                    state.robustness = robustness;
+                    if (m_candidate_scope.test(static_cast<size_t>(m_discrepancy_ordinal[predicate.node_index]))) {
+                        m_scores_dirty = true;
                     }
+                }
 
-                    if (source_name_for_predicate == sample.parameterID) {
-                        double robustness = calculateRobustness(*node.predicate, sample.value, range_min, range_max);
-                        
-                        // Update robustness for inactive nodes to reflect current state (e.g. negative or positive-but-blocked)
-                        if (!node_states[node.id].is_active) {
-                            node_states[node.id].robustness = robustness;
-                        }
-
-                        if (robustness > 0 && !node_states[node.id].is_active) {
-                            bool condition_met = true;
-                            if (node.gate_type == GateType::AND) {
-                                for (const auto& edge : model.getEdges()) {
-                                    if (edge.to == node.id) {
-                                        if (!node_states[edge.from].is_active || node_states[edge.from].activation_time_ms > sample.timestamp_ms) {
-                                            condition_met = false;
-                                            break;
-                                        }
-                                    }
-                                }
-                            }
-
-                            if (condition_met) {
-                                node_states[node.id].is_active = true;
-                                node_states[node.id].robustness = robustness;
-                                node_states[node.id].activation_time_ms = sample.timestamp_ms;
-                                std::cout << "Node " << node.id << " (" << node.name << ") activated at time " << sample.timestamp_ms << "ms";
-                                std::cout << " (" << source_name_for_predicate << ": " << sample.value << node.predicate->op << node.predicate->threshold << ").\n";
-                                node_states[node.id].trigger_value = sample.value;
-                            }
-                        }
+                if (predicate.isSatisfied(robustness) && !state.is_active) {
+                    if (isGateSatisfied(predicate.node_index, sample.timestamp_ms)) {
+                        activateDiscrepancy(predicate.node_index, sample.timestamp_ms, sample.value, robustness);
+                    } else {
+                        m_blocked.push_back({predicate.node_index, sample.timestamp_ms, sample.value, robustness});
                     }
                 }
             }
         } else {
             // This is a fault injection (e.g., "Pump_Motor_Burnout")
-            std::string target_node_id = sample.parameterID;
-            bool found = false;
-
-            if (node_states.find(target_node_id) != node_states.end()) {
-                found = true;
-            } else {
-                for (const auto& node : model.getNodes()) {
-                    if (node.name == sample.parameterID) {
-                        target_node_id = node.id;
-                        found = true;
+            const std::string& parameter_id = *sample.fault_name;
+            int target_index = sample.parameter != kNoSymbol ? m_model.getNodeIndex(sample.parameter)
+                                                             : m_model.getNodeIndex(parameter_id);
+            if (target_index < 0) {
+                for (size_t i = 0; i < nodes.size(); ++i) {
+                    if (nodes[i].name == parameter_id) {
+                        target_index = static_cast<int>(i);
                         break;
                     }
                 }
             }
 
-            if (found) {
-                auto& state = node_states[target_node_id];
+            if (target_index >= 0) {
+                auto& state = m_node_states[static_cast<size_t>(target_index)];
                 if (!state.is_active && sample.value > 0) {
                     state.is_active = true;
                     state.activation_time_ms = sample.timestamp_ms;
-                    std::cout << "FAULT INJECTED: " << sample.parameterID << " activated at time " << sample.timestamp_ms << "ms.\n";
                     state.trigger_value = sample.value;
-                    // std::cout << "FAULT INJECTED: " << sample.parameterID << " activated at time " << sample.timestamp_ms << "ms.\n";
+                    noteActivation(static_cast<size_t>(target_index));
+                    m_event_sink->onFaultInjected({static_cast<size_t>(target_index), &parameter_id, sample.timestamp_ms, sample.value});
                 }
             }
         }
     }
+    return evaluated;
+}
+
+// Blocked activations are retried before every sample, as a diagnosis call per sample would, so each
+// activation keeps the timestamp it gets in a sample-by-sample run.
+size_t LogicEngine::advance(size_t max_samples) {
+    size_t evaluated = 0;
+    while (evaluated < max_samples) {
+        retryBlockedActivations();
+        if (evaluateNewSamples(1) == 0) break;
+        ++evaluated;
+    }
+    return evaluated;
 }
 
 // REQ-ENG-04: Main function to run the reasoning process.
-std::vector<DiagnosisResult> LogicEngine::findActiveHypotheses() {
-    // std::cout << "--- Starting Logic Engine ---" << std::endl;
+bool LogicEngine::refreshCandidates() {
+    // 1. Evaluate predicates based on signal data (REQ-ENG-01, REQ-ENG-03) to detect Discrepancies.
+    //    Only samples ingested since the previous call are visited; blocked AND gates are retried first.
+    retryBlockedActivations();
+    evaluateNewSamples(SIZE_MAX);
+
+    if (!m_candidates_dirty) return false;
 
-    // 1. Evaluate predicates based on signal data (REQ-ENG-01, REQ-ENG-03) to detect Discrepancies
-    evaluateSignalTrace(m_model, m_ingestor, m_node_states);
+    // 2. Backward Propagation (BProp) - Trace back to find potential root causes. No edge leaves a
+    //    partition, so only partitions with a new activation are traced again, possibly concurrently;
+    //    each writes its own candidate list.
+    size_t work = 0;
+    for (size_t p : m_dirty_partitions) work += m_graph.partitionMembers(p).size();
+    m_workers.parallelFor(m_dirty_partitions.size(), work, [this](size_t i) {
+        PartitionState& partition = m_partitions[m_dirty_partitions[i]];
+        partition.candidates = backwardPropagate(partition.active_symptoms, m_bprop_marks);
+    });
+    m_counters.partition_refreshes += m_dirty_partitions.size();
+    for (size_t p : m_dirty_partitions) m_partitions[p].dirty = false;
+    m_dirty_partitions.clear();
 
-    // Build a lookup map for nodes
-    std::unordered_map<std::string, Node> node_map;
-    for (const auto& node : m_model.getNodes()) {
-        node_map[node.id] = node;
+    // Merge in node ID order, the order of the original string-keyed candidate set, so the ranking
+    // does not depend on the partitioning or on which worker finished first.
+    m_cached_candidates.clear();
+    for (const PartitionState& partition : m_partitions) {
+        m_cached_candidates.insert(m_cached_candidates.end(), partition.candidates.begin(), partition.candidates.end());
     }
+    std::sort(m_cached_candidates.begin(), m_cached_candidates.end(),
+              [this](size_t a, size_t b) { return m_id_ranks[a] < m_id_ranks[b]; });
 
-    // Identify newly active discrepancies (Symptoms)
-    std::vector<std::string> active_symptoms;
-    for (const auto& [id, state] : m_node_states) {
-        if (state.is_active && node_map.count(id) && node_map.at(id).type == NodeType::Discrepancy) {
-            active_symptoms.push_back(id);
-        }
+    m_candidate_scope.clear();
+    m_candidate_symptom_total = 0;
+    for (size_t fm : m_cached_candidates) {
+        m_candidate_scope |= m_failure_signatures[fm].expected;
+        m_candidate_symptom_total += m_failure_signatures[fm].expected_count;
     }
+    m_candidates_dirty = false;
+    return true;
+}
 
-    std::set<std::string> candidate_failures;
+double LogicEngine::aggregateRobustness(const FailureSignature& signature) const {
+    double sum_all_robustness = 0.0;
+    for (size_t s : signature.expected_by_id) {
+        sum_all_robustness += m_node_states[s].robustness;
+    }
+    // Calculate Aggregate Robustness normalized between -1.0 and 1.0
+    double aggregate_robustness = sum_all_robustness / signature.expected_count;
+    // Clamp to -1.0 to 1.0
+    return std::max(-1.0, std::min(1.0, aggregate_robustness));
+}
 
-    // 2. Backward Propagation (BProp) - Trace back to find potential root causes
-    std::function<void(std::string)> backwardPropagate = [&](std::string current_id) {
-        for (const auto& edge : m_model.getEdges()) {
-            if (edge.to == current_id) {
-                std::string parent_id = edge.from;
-                
-                if (node_map.at(parent_id).type == NodeType::FailureMode) {
-                    candidate_failures.insert(parent_id);
-                } else if (node_map.at(parent_id).type == NodeType::Discrepancy) {
-                    // Check consistency: Parent must be active and within time window
-                    if (m_node_states.count(parent_id) && m_node_states.at(parent_id).is_active) {
-                        double t_child = m_node_states.at(current_id).activation_time_ms;
-                        double t_parent = m_node_states.at(parent_id).activation_time_ms;
-                        double delta = t_child - t_parent;
-
-                        if (delta >= edge.time_min_ms && delta <= edge.time_max_ms) {
-                            backwardPropagate(parent_id);
-                        }
-                    }
-                }
-            }
-        }
-    };
+DiagnosisResult LogicEngine::buildDiagnosis(size_t fm, double plausibility, double robustness, std::vector<size_t>& arena) const {
+    const std::vector<size_t>& expected = m_failure_signatures[fm].expected_by_id;
+    size_t first = arena.size();
+    for (size_t s : expected) {
+        if (m_node_states[s].is_active) arena.push_back(s);
+    }
+    return {fm, plausibility, robustness, IndexSpan(expected.data(), expected.size()),
+            IndexSpan(arena.data() + first, arena.size() - first)};
+}
 
-    for (const auto& symptom : active_symptoms) {
-        backwardPropagate(symptom);
-    }
-
-    // 3. Forward Propagation (FProp) & Consistency Check
-    std::vector<DiagnosisResult> ranked_diagnoses;
-
-    for (const auto& fm_id : candidate_failures) {
-        // Calculate Plausibility: (Consistent Symptoms / Expected Symptoms)
-        std::set<std::string> expected_symptoms;
-        std::vector<std::string> queue = {fm_id};
-        std::set<std::string> visited = {fm_id};
-        
-        while (!queue.empty()) {
-            std::string u = queue.front();
-            queue.erase(queue.begin());
-            for (const auto& edge : m_model.getEdges()) {
-                if (edge.from == u && visited.find(edge.to) == visited.end()) {
-                    visited.insert(edge.to);
-                    queue.push_back(edge.to);
-                    if (node_map.at(edge.to).type == NodeType::Discrepancy) {
-                        expected_symptoms.insert(edge.to);
-                    }
-                }
-            }
-        }
+// Plausibility is consistent / expected, and division is correctly rounded, so equal fractions
+// are equal doubles and need no tolerance. The node ID tie-break makes std::sort in
+// findActiveHypotheses() and std::partial_sort in findTopHypotheses() agree on exact ties.
+bool LogicEngine::ranksBefore(size_t fm_a, double plausibility_a, double robustness_a,
+                              size_t fm_b, double plausibility_b, double robustness_b) const {
+    if (plausibility_a != plausibility_b) return plausibility_a > plausibility_b;
+    if (robustness_a != robustness_b) return robustness_a > robustness_b;
+    return m_id_ranks[fm_a] < m_id_ranks[fm_b];
+}
 
-        int consistent_count = 0;
-        double sum_all_robustness = 0.0;
-        std::vector<std::string> consistent_symptoms;
-        std::map<std::string, double> symptom_values;
-        for (const auto& s_id : expected_symptoms) {
-            if (m_node_states.count(s_id)) {
-                sum_all_robustness += m_node_states.at(s_id).robustness;
-                if (m_node_states.at(s_id).is_active) {
-                    consistent_count++;
-                    consistent_symptoms.push_back(s_id);
-                    symptom_values[s_id] = m_node_states.at(s_id).trigger_value;
-                }
-            }
-        }
+const std::vector<DiagnosisResult>& LogicEngine::findActiveHypotheses() {
+    m_counters.diagnosis_calls++;
+    bool candidates_rebuilt = refreshCandidates();
 
-        double plausibility = expected_symptoms.empty() ? 0.0 : (double)consistent_count / expected_symptoms.size();
-        
-        // Calculate Aggregate Robustness normalized between -1.0 and 1.0
-        double aggregate_robustness = 0.0;
-        if (!expected_symptoms.empty()) {
-            aggregate_robustness = sum_all_robustness / expected_symptoms.size();
-            // Clamp to -1.0 to 1.0
-            aggregate_robustness = std::max(-1.0, std::min(1.0, aggregate_robustness));
-        }
+    // Nothing that feeds BProp, FProp or scoring changed since the last call: reuse its ranking.
+    if (!m_scores_dirty) {
+        m_counters.diagnosis_cache_hits++;
+        return m_cached_diagnoses;
+    }
+    if (!candidates_rebuilt) {
+        // Only robustness values of candidate symptoms moved; the previous BProp result still holds.
+        m_counters.diagnosis_rescores++;
+    }
 
-        if (plausibility > 0.0) {
-            ranked_diagnoses.push_back({node_map.at(fm_id), plausibility, aggregate_robustness, expected_symptoms, consistent_symptoms, symptom_values});
-        }
+    // 3. Forward Propagation (FProp) & Consistency Check. Ranked in place in the reused buffers; the
+    //    arena is reserved up front so the spans handed out below are never invalidated.
+    std::vector<DiagnosisResult>& ranked_diagnoses = m_cached_diagnoses;
+    ranked_diagnoses.clear();
+    m_consistent_arena.clear();
+    m_consistent_arena.reserve(m_candidate_symptom_total);
+
+    for (size_t fm : m_cached_candidates) {
+        // Calculate Plausibility: (Consistent Symptoms / Expected Symptoms), word-parallel on the bitsets
+        const FailureSignature& signature = m_failure_signatures[fm];
+        size_t consistent_count = BitSet::countAnd(signature.expected, m_active_discrepancies);
+        if (consistent_count == 0) continue; // Plausibility 0: not a hypothesis
+        double plausibility = (double)consistent_count / signature.expected_count;
+
+        ranked_diagnoses.push_back(buildDiagnosis(fm, plausibility, aggregateRobustness(signature), m_consistent_arena));
     }
 
     // 4. Rank by Plausibility/Robustness
-    std::sort(ranked_diagnoses.begin(), ranked_diagnoses.end(), [](const DiagnosisResult& a, const DiagnosisResult& b) {
-        if (std::abs(a.plausibility - b.plausibility) > 1e-6) {
-            return a.plausibility > b.plausibility;
-        }
-        return a.robustness > b.robustness;
+    std::sort(ranked_diagnoses.begin(), ranked_diagnoses.end(), [this](const DiagnosisResult& a, const DiagnosisResult& b) {
+        return ranksBefore(a.node_index, a.plausibility, a.robustness, b.node_index, b.plausibility, b.robustness);
     });
 
-    // std::cout << "--- Logic Engine Finished ---\n" << std::endl;
+    m_scores_dirty = false;
+
     return ranked_diagnoses;
+}
+
+const std::vector<DiagnosisResult>& LogicEngine::findTopHypotheses(size_t k, double min_plausibility) {
+    m_counters.top_k_calls++;
+    refreshCandidates();
+
+    std::vector<DiagnosisResult>& top = m_top_diagnoses;
+    top.clear();
+    if (k == 0) return top;
+
+    // Phase 1: plausibility only. It is a popcount over the signature bitsets, so every candidate
+    // gets one; the per-symptom robustness sum is deferred until a candidate can still place.
+    std::vector<ScoredCandidate>& scored = m_top_scored;
+    scored.clear();
+    for (size_t fm : m_cached_candidates) {
+        const FailureSignature& signature = m_failure_signatures[fm];
+        size_t consistent_count = BitSet::countAnd(signature.expected, m_active_discrepancies);
+        if (consistent_count == 0) continue; // Plausibility 0: not a hypothesis
+        double plausibility = (double)consistent_count / signature.expected_count;
+        if (plausibility < min_plausibility) continue;
+        scored.push_back({fm, plausibility, 0.0});
+    }
+
+    // Phase 2: robustness only breaks plausibility ties, so a candidate below the K-th best plausibility
+    // is outranked by at least K others whatever its robustness.
+    if (scored.size() > k) {
+        std::nth_element(scored.begin(), scored.begin() + (k - 1), scored.end(), [](const ScoredCandidate& a, const ScoredCandidate& b) {
+            return a.plausibility > b.plausibility;
+        });
+        double cutoff = scored[k - 1].plausibility;
+        size_t before = scored.size();
+        scored.erase(std::remove_if(scored.begin(), scored.end(), [cutoff](const ScoredCandidate& s) {
+            return s.plausibility < cutoff;
+        }), scored.end());
+        m_counters.hypotheses_pruned += before - scored.size();
+    }
+
+    // Phase 3: full scoring of the survivors, partial selection of the best K.
+    for (ScoredCandidate& s : scored) {
+        s.robustness = aggregateRobustness(m_failure_signatures[s.fm]);
+    }
+    size_t count = std::min(k, scored.size());
+    std::partial_sort(scored.begin(), scored.begin() + count, scored.end(), [this](const ScoredCandidate& a, const ScoredCandidate& b) {
+        return ranksBefore(a.fm, a.plausibility, a.robustness, b.fm, b.plausibility, b.robustness);
+    });
+
+    m_top_consistent_arena.clear();
+    m_top_consistent_arena.reserve(m_candidate_symptom_total);
+    for (size_t i = 0; i < count; ++i) {
+        top.push_back(buildDiagnosis(scored[i].fm, scored[i].plausibility, scored[i].robustness, m_top_consistent_arena));
+    }
+    return top;
 }
\ No newline at end of file
@@ -16,10 +16,16 @@
 
 #include "rTFPGModel.h"
 #include "SignalIngestor.h"
+#include "ActivationEventSink.h"
+#include "BitSet.h"
+#include "IndexSpan.h"
+#include "WorkerPool.h"
 #include <vector>
 #include <string>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
 #include <unordered_map>
-#include <set>
 
 // Represents the activation state of a node at a specific time.
 struct NodeState {
@@ -29,31 +35,234 @@ struct NodeState {
     double trigger_value = 0.0;
 };
 
-/// @brief Holds the result of a diagnosis, including the failure node and scoring metrics.
+/// @brief Running counters of the engine's work, for profiling on real traces.
+struct EngineCounters {
+    uint64_t samples_evaluated = 0;     ///< Samples folded into the node states
+    uint64_t activations = 0;           ///< Node activations (discrepancies and fault injections)
+    uint64_t diagnosis_calls = 0;       ///< Calls to findActiveHypotheses()
+    uint64_t diagnosis_cache_hits = 0;  ///< Calls answered from the cached ranking
+    uint64_t diagnosis_rescores = 0;    ///< Calls that reused the cached candidates but rescored them
+    uint64_t top_k_calls = 0;           ///< Calls to findTopHypotheses(), which bypass the cache
+    uint64_t hypotheses_pruned = 0;     ///< Candidates findTopHypotheses() skipped before full scoring
+    uint64_t partition_refreshes = 0;   ///< Graph partitions whose BProp candidates were rebuilt
+
+    /// @brief Fraction of diagnosis calls served from the cache, in [0, 1].
+    double cacheHitRate() const {
+        return diagnosis_calls == 0 ? 0.0 : static_cast<double>(diagnosis_cache_hits) / diagnosis_calls;
+    }
+};
+
+/**
+ * @brief Holds the result of a diagnosis: the failure node (by dense node index) and scoring metrics.
+ * @note The symptom spans point into engine-owned storage and are valid until the next call to
+ *       findActiveHypotheses()/findTopHypotheses() on the same engine. Resolve names and values
+ *       through rTFPGModel::getNodes() and LogicEngine::getDenseNodeStates() when rendering.
+ */
 struct DiagnosisResult {
-    Node node;
+    size_t node_index;
     double plausibility;
     double robustness;
-    std::set<std::string> expected_symptoms;
-    std::vector<std::string> consistent_symptoms;
-    std::map<std::string, double> symptom_values;
+    IndexSpan expected_symptoms;   // Ordered by node ID
+    IndexSpan consistent_symptoms; // The active subset of expected_symptoms, same order
 };
 
 class LogicEngine {
 public:
     LogicEngine(const rTFPGModel& model, const SignalIngestor& ingestor);
 
-    // REQ-ENG-04: Main function to run the reasoning process.
-    std::vector<DiagnosisResult> findActiveHypotheses();
+    /**
+     * @brief REQ-ENG-04: Main function to run the reasoning process.
+     * @return The ranked hypotheses; valid until the next diagnosis call. Once the engine's buffers
+     *         have grown to the model's size, calls that do not activate a node allocate nothing.
+     */
+    const std::vector<DiagnosisResult>& findActiveHypotheses();
+
+    /**
+     * @brief Folds pending samples into the node states without running a diagnosis, for batch replay.
+     * @param max_samples Evaluate at most this many samples; the rest stay pending.
+     * @return The number of samples evaluated.
+     * @note Activations are reported to the event sink with the same timestamps as when
+     *       findActiveHypotheses() is called after every sample. Call it at checkpoints afterwards.
+     */
+    size_t advance(size_t max_samples = SIZE_MAX);
+
+    /**
+     * @brief Returns only the K best hypotheses, ranked like findActiveHypotheses().
+     * @param k Maximum number of results.
+     * @param min_plausibility Hypotheses below this plausibility are not returned.
+     * @note Candidates that cannot reach the top K on plausibility are skipped before their
+     *       robustness and symptom lists are computed. The result is valid until the next diagnosis call.
+     */
+    const std::vector<DiagnosisResult>& findTopHypotheses(size_t k, double min_plausibility = 0.0);
+
+    /**
+     * @brief Node states indexed by dense node index (position in rTFPGModel::getNodes()).
+     */
+    const std::vector<NodeState>& getDenseNodeStates() const { return m_node_states; }
 
-    const std::unordered_map<std::string, NodeState>& getNodeStates() const { return m_node_states; }
+    /**
+     * @brief Compatibility view of the node states keyed by node ID.
+     * @note Materializes a map on every call; prefer getDenseNodeStates() on hot paths.
+     */
+    std::unordered_map<std::string, NodeState> getNodeStates() const;
+
+    /**
+     * @brief Routes activation and fault injection events to the given sink.
+     * @param sink Must outlive the engine. Defaults to ConsoleEventSink::standardOutput().
+     */
+    void setEventSink(ActivationEventSink& sink) { m_event_sink = &sink; }
+
+    /**
+     * @brief Rebuilds the candidates of up to this many graph partitions concurrently.
+     * @param count Worker threads, the calling thread included. 1 (the default) stays single-threaded.
+     *        The ranking is the same for any count. The helper threads persist for the engine's
+     *        lifetime; rebuilds touching fewer than WorkerPool::kMinParallelWork nodes run inline.
+     */
+    void setWorkerThreads(size_t count) { m_workers.setWorkerCount(count); }
+
+    const EngineCounters& getCounters() const { return m_counters; }
+
+    // Number of ingested samples already folded into the node states (the consume cursor).
+    size_t getConsumedSampleCount() const { return static_cast<size_t>(m_cursor.arrivals); }
+    /// @brief The engine's read position in the ingested stream, a watermark for SignalIngestor::compact().
+    const IngestCursor& getCursor() const { return m_cursor; }
 
 private:
+    // A satisfied predicate whose AND gate was still blocked when its sample was evaluated.
+    // Kept so that a later parent activation can still fire it, exactly as a full rescan would.
+    struct BlockedActivation {
+        size_t node_index;        // Position of the node in m_model.getNodes()
+        uint64_t timestamp_ms;
+        double value;
+        double robustness;
+    };
+
+    /**
+     * @brief REQ-ENG-03 / FR-05.1: A discrepancy predicate compiled against its signal's range.
+     * @refinement robustness = margin * scale, with margin = x - threshold (or, for == and !=,
+     *             tolerance - |x - threshold|) and scale = ±1/range folding in the operator
+     *             direction. Positive means satisfied; zero is satisfied for <=, >= and ==.
+     */
+    struct CompiledPredicate {
+        static constexpr double kEqualityTolerance = 1e-9;
+
+        size_t node_index;        // Position of the node in m_model.getNodes()
+        double threshold;
+        double scale;
+        bool distance;            // == and != compare |x - threshold| against the tolerance
+        bool inclusive;           // The boundary (robustness 0) satisfies the predicate
+
+        double robustness(double value) const {
+            double delta = value - threshold;
+            double margin = distance ? kEqualityTolerance - std::abs(delta) : delta;
+            return margin * scale;
+        }
+        bool isSatisfied(double robustness) const {
+            return inclusive ? robustness >= 0.0 : robustness > 0.0;
+        }
+    };
+
+    using AdjacentEdge = CompiledGraph::AdjacentEdge;
+
     const rTFPGModel& m_model;
     const SignalIngestor& m_ingestor;
+    // Parents/children of each node; the model must not be mutated while the engine is in use
+    const CompiledGraph& m_graph;
+    const std::vector<uint32_t>& m_id_ranks; // Node ID order, for ranking ties (rTFPGModel::getNodeIdRanks())
+    ActivationEventSink* m_event_sink;
+
+    // Current state (active, robustness, time) of each node, indexed by dense node index
+    std::vector<NodeState> m_node_states;
+
+    // Discrepancy node index -> sorted failure mode indices that can explain it (FR-07)
+    std::vector<std::vector<size_t>> m_ancestor_failures;
+
+    // FProp result of a failure mode, precomputed from the model.
+    struct FailureSignature {
+        BitSet expected;                     // Reachable discrepancies, by discrepancy ordinal
+        size_t expected_count = 0;           // popcount(expected)
+        std::vector<size_t> expected_by_id;  // The same nodes as indices, in node ID order for reporting
+    };
+
+    // Node index -> ordinal among discrepancy nodes (bit position in the bitsets), or -1
+    std::vector<int> m_discrepancy_ordinal;
+    // Failure mode node index -> its expected symptoms (empty for discrepancies)
+    std::vector<FailureSignature> m_failure_signatures;
+    // Currently active discrepancies, by discrepancy ordinal
+    BitSet m_active_discrepancies;
+
+    // Signal internal ID (SignalIngestor) -> predicates that read that signal, in model node order.
+    std::vector<std::vector<CompiledPredicate>> m_signal_dependents;
+    // Node position -> internal ID of the signal its predicate reads, or -1.
+    std::vector<int> m_predicate_signal;
+
+    // BProp state of one weakly connected component (CompiledGraph partition). An activation only
+    // invalidates the candidates of its own partition.
+    struct PartitionState {
+        std::vector<size_t> active_symptoms; // In activation order
+        std::vector<size_t> candidates;      // BProp result, ascending
+        bool dirty = false;                  // Listed in m_dirty_partitions
+    };
+    std::vector<PartitionState> m_partitions;
+    std::vector<size_t> m_dirty_partitions;
+    std::vector<uint8_t> m_bprop_marks;      // Scratch for backwardPropagate(), all zero between calls
+    WorkerPool m_workers;
+
+    // Diagnosis cache. An activation invalidates the BProp candidates and the ranking; a robustness
+    // change on an expected symptom of a current candidate (m_candidate_scope) only the ranking.
+    std::vector<size_t> m_cached_candidates; // All partitions' candidates, in node ID order
+    size_t m_candidate_symptom_total = 0;    // Sum of the candidates' expected symptom counts
+    BitSet m_candidate_scope;
+    std::vector<DiagnosisResult> m_cached_diagnoses;
+    bool m_candidates_dirty = true;
+    bool m_scores_dirty = true;
+    EngineCounters m_counters;
+
+    // Candidate being ranked by findTopHypotheses().
+    struct ScoredCandidate {
+        size_t fm;
+        double plausibility;
+        double robustness;
+    };
+
+    // Reused buffers, so that steady-state diagnosis calls do not allocate. The arenas back the
+    // consistent_symptoms spans of m_cached_diagnoses and m_top_diagnoses respectively.
+    std::vector<size_t> m_consistent_arena;
+    std::vector<ScoredCandidate> m_top_scored;
+    std::vector<size_t> m_top_consistent_arena;
+    std::vector<DiagnosisResult> m_top_diagnoses;
+
+    // REQ-ENG-01: Position of the next sample in the ingested stream that has not been evaluated yet.
+    IngestCursor m_cursor;
+    // Blocked AND-gate activations, in the order their samples were evaluated.
+    std::vector<BlockedActivation> m_blocked;
+    // Set whenever a node activates; blocked activations only need a retry after that.
+    bool m_retry_blocked = false;
+
+    static CompiledPredicate compilePredicate(size_t node_index, const NodeRecord& predicate,
+                                              double range_min, double range_max);
+    void buildAncestorIndex();
+    void buildFailureSignatures();
+    void buildSignalDependencyIndex();
+    size_t evaluateNewSamples(size_t max_samples);
+    void retryBlockedActivations();
+    bool isGateSatisfied(size_t node_index, uint64_t timestamp_ms) const;
+    bool isBlockedForever(size_t node_index, uint64_t timestamp_ms) const;
+    std::vector<size_t> backwardPropagate(const std::vector<size_t>& active_symptoms, std::vector<uint8_t>& marks) const;
+
+    // Orders by plausibility, then aggregate robustness, then node ID. Scores are compared exactly:
+    // a tolerance would make equivalence non-transitive, which the std sorting algorithms forbid.
+    bool ranksBefore(size_t fm_a, double plausibility_a, double robustness_a,
+                     size_t fm_b, double plausibility_b, double robustness_b) const;
 
-    // Maps node ID to its current state (active, robustness, time)
-    std::unordered_map<std::string, NodeState> m_node_states;
+    // Steps 1-2 of a diagnosis: fold new samples into the node states, rerun BProp if anything
+    // activated. Returns true if the candidates were rebuilt.
+    bool refreshCandidates();
+    double aggregateRobustness(const FailureSignature& signature) const;
+    // Appends the active expected symptoms of fm to arena, which must have the capacity reserved.
+    DiagnosisResult buildDiagnosis(size_t fm, double plausibility, double robustness, std::vector<size_t>& arena) const;
+    void activateDiscrepancy(size_t node_index, uint64_t timestamp_ms, double value, double robustness);
+    void noteActivation(size_t node_index);
 };
 
 #endif // LOGIC_ENGINE_H
\ No newline at end of file
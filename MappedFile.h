@@ -0,0 +1,38 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+/**
+ * @class MappedFile
+ * @brief Read-only memory mapping of a whole file (POSIX mmap / Win32 file mapping).
+ *
+ * The mapping is released when the object is destroyed. Empty files map to a null view of size 0.
+ */
+
+#include <cstddef>
+#include <string>
+
+class MappedFile {
+public:
+    /**
+     * @brief Maps the file read-only.
+     * @throws std::runtime_error if the file cannot be opened or mapped.
+     */
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const unsigned char* data() const { return m_data; }
+    size_t size() const { return m_size; }
+
+private:
+    const unsigned char* m_data = nullptr;
+    size_t m_size = 0;
+#if defined(_WIN32)
+    void* m_file = nullptr;
+    void* m_mapping = nullptr;
+#endif
+};
+
+#endif // MAPPED_FILE_H
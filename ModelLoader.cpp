@@ -0,0 +1,74 @@
+#include "ModelLoader.h"
+#include "JsonSectionSax.h"
+#include <utility>
+
+namespace {
+
+using json = nlohmann::json;
+
+// Collects the parsed elements of the model sections; all other root members are skipped.
+class ModelSaxHandler : public JsonSectionSax {
+public:
+    std::vector<Signal> signals;
+    std::vector<NodeDefinition> nodes;
+    std::vector<Edge> edges;
+    std::vector<SubgraphTemplate> templates;
+    std::vector<SubgraphInstance> instances;
+
+protected:
+    Member memberFor(const std::string& key) override {
+        m_section = sectionFor(key);
+        // As with a parsed document, a repeated key replaces the earlier section.
+        switch (m_section) {
+            case Section::Signals: signals.clear(); break;
+            case Section::Nodes: nodes.clear(); break;
+            case Section::Edges: edges.clear(); break;
+            case Section::Templates: templates.clear(); break;
+            case Section::Instances: instances.clear(); break;
+            case Section::None: return Member::Skip;
+        }
+        return Member::Section;
+    }
+
+    // Scalar elements are invalid, but go through the element parsers so the error matches.
+    void onElement(json& element) override {
+        switch (m_section) {
+            case Section::Signals: signals.push_back(parseSignal(element)); break;
+            case Section::Nodes: nodes.push_back(parseNode(element)); break;
+            case Section::Edges: edges.push_back(parseEdge(element)); break;
+            case Section::Templates: templates.push_back(parseTemplate(element)); break;
+            case Section::Instances: instances.push_back(parseInstance(element)); break;
+            case Section::None: break;
+        }
+    }
+
+private:
+    enum class Section { None, Signals, Nodes, Edges, Templates, Instances };
+
+    Section m_section = Section::None; // Section named by the current root key
+
+    static Section sectionFor(const std::string& key) {
+        if (key == "signals") return Section::Signals;
+        if (key == "nodes") return Section::Nodes;
+        if (key == "edges") return Section::Edges;
+        if (key == "templates") return Section::Templates;
+        if (key == "instances") return Section::Instances;
+        return Section::None;
+    }
+};
+
+} // namespace
+
+rTFPGModel ModelLoader::parse(std::istream& input) {
+    ModelSaxHandler handler;
+    json::sax_parse(input, &handler);
+    instantiateTemplates(handler.templates, handler.instances, handler.nodes, handler.edges);
+    return rTFPGModel(std::move(handler.signals), std::move(handler.nodes), std::move(handler.edges));
+}
+
+rTFPGModel ModelLoader::parse(const std::string& text) {
+    ModelSaxHandler handler;
+    json::sax_parse(text, &handler);
+    instantiateTemplates(handler.templates, handler.instances, handler.nodes, handler.edges);
+    return rTFPGModel(std::move(handler.signals), std::move(handler.nodes), std::move(handler.edges));
+}
@@ -0,0 +1,31 @@
+#ifndef MODEL_LOADER_H
+#define MODEL_LOADER_H
+
+/**
+ * @class ModelLoader
+ * @brief Streaming (SAX) loader for JSON fault models.
+ *
+ * Builds an rTFPGModel in a single pass over the JSON text without materializing the document.
+ * Only the element of the "signals", "nodes", "edges", "templates" or "instances" array currently
+ * being read is held as a small JSON value, which is handed to the same parse functions the DOM
+ * constructor uses, so field validation and its exceptions are identical. All other top-level
+ * members are skipped as they stream past. Instances are expanded once the whole file is read.
+ *
+ * Elements are validated in file order. For a model whose sections appear in another order than
+ * signals, nodes, edges, templates, instances and that contains several invalid elements, the first
+ * error reported may therefore differ from rTFPGModel(const nlohmann::json&). Syntax errors surface as the same
+ * nlohmann::json::parse_error, but only once the parser reaches them.
+ */
+
+#include "rTFPGModel.h"
+#include <istream>
+#include <string>
+
+class ModelLoader {
+public:
+    /// @throws nlohmann::json::exception as described above, std::invalid_argument as rTFPGModel does.
+    static rTFPGModel parse(std::istream& input);
+    static rTFPGModel parse(const std::string& text);
+};
+
+#endif // MODEL_LOADER_H
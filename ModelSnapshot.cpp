@@ -0,0 +1,380 @@
+#include "ModelSnapshot.h"
+#include "MappedFile.h"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+constexpr char kMagic[8] = {'R', 'T', 'F', 'P', 'G', 'S', 'N', 'P'};
+constexpr uint32_t kByteOrderMark = 0x01020304u;
+
+// Fixed 72-byte file header; the payload follows it directly.
+struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint64_t source_hash;
+    uint64_t payload_size;
+    uint64_t payload_checksum;
+    uint32_t string_count;
+    uint32_t signal_count;
+    uint32_t node_count;
+    uint32_t edge_count;       // Edges as listed in the model, including unresolved ones
+    uint32_t graph_edge_count; // Edges in the compiled CSR adjacency
+    uint32_t reserved[3];
+};
+static_assert(sizeof(Header) == 72, "Snapshot header layout must not depend on the compiler");
+
+enum : uint8_t { kNoGate = 0, kGateOr = 1, kGateAnd = 2 };
+
+// Appends plain values to the payload.
+class Writer {
+public:
+    template <typename T>
+    void put(const T& value) {
+        const auto* bytes = reinterpret_cast<const unsigned char*>(&value);
+        m_bytes.insert(m_bytes.end(), bytes, bytes + sizeof(T));
+    }
+    template <typename T>
+    void putArray(const std::vector<T>& values) {
+        const auto* bytes = reinterpret_cast<const unsigned char*>(values.data());
+        m_bytes.insert(m_bytes.end(), bytes, bytes + values.size() * sizeof(T));
+    }
+    void putBytes(const std::string& text) { m_bytes.insert(m_bytes.end(), text.begin(), text.end()); }
+    void align() { m_bytes.resize((m_bytes.size() + 7) & ~size_t{7}, 0); }
+    const std::vector<unsigned char>& bytes() const { return m_bytes; }
+
+private:
+    std::vector<unsigned char> m_bytes;
+};
+
+// Bounds-checked sequential reads from the mapped payload.
+class Reader {
+public:
+    Reader(const unsigned char* data, size_t size) : m_begin(data), m_pos(data), m_end(data + size) {}
+
+    template <typename T>
+    T get() {
+        T value;
+        std::memcpy(&value, take(sizeof(T)), sizeof(T));
+        return value;
+    }
+    template <typename T>
+    void getArray(std::vector<T>& values, size_t count) {
+        values.resize(count);
+        if (count > 0) std::memcpy(values.data(), take(count * sizeof(T)), count * sizeof(T));
+    }
+    const char* getBytes(size_t count) { return reinterpret_cast<const char*>(take(count)); }
+    void align() { take(((m_pos - m_begin + 7) & ~std::ptrdiff_t{7}) - (m_pos - m_begin)); }
+
+private:
+    const unsigned char* m_begin;
+    const unsigned char* m_pos;
+    const unsigned char* m_end;
+
+    const unsigned char* take(size_t count) {
+        if (static_cast<size_t>(m_end - m_pos) < count) {
+            throw std::runtime_error("Model snapshot is truncated.");
+        }
+        const unsigned char* at = m_pos;
+        m_pos += count;
+        return at;
+    }
+};
+
+// Snapshot-local string table: each distinct string is stored once and referenced by position.
+class StringPool {
+public:
+    uint32_t add(const std::string& text) {
+        auto it = m_index.find(text);
+        if (it != m_index.end()) return it->second;
+        uint32_t index = static_cast<uint32_t>(m_strings.size());
+        m_index.emplace(text, index);
+        m_strings.push_back(text);
+        return index;
+    }
+    const std::vector<std::string>& strings() const { return m_strings; }
+
+private:
+    std::unordered_map<std::string, uint32_t> m_index;
+    std::vector<std::string> m_strings;
+};
+
+void writeCsr(Writer& out, const std::vector<uint32_t>& offsets, const std::vector<uint32_t>& neighbors,
+              const std::vector<int>& time_min_ms, const std::vector<int>& time_max_ms) {
+    out.putArray(offsets);
+    out.putArray(neighbors);
+    out.putArray(time_min_ms);
+    out.putArray(time_max_ms);
+    out.align();
+}
+
+void readCsr(Reader& in, size_t node_count, size_t edge_count, std::vector<uint32_t>& offsets,
+             std::vector<uint32_t>& neighbors, std::vector<int>& time_min_ms, std::vector<int>& time_max_ms) {
+    in.getArray(offsets, node_count + 1);
+    in.getArray(neighbors, edge_count);
+    in.getArray(time_min_ms, edge_count);
+    in.getArray(time_max_ms, edge_count);
+    in.align();
+
+    // The checksum guards against corruption; this guards the engine against a malformed writer.
+    if (offsets.front() != 0 || offsets.back() != edge_count) {
+        throw std::runtime_error("Model snapshot has an inconsistent adjacency.");
+    }
+    for (size_t e = 0; e < edge_count; ++e) {
+        if (time_min_ms[e] < 0 || time_min_ms[e] > time_max_ms[e]) {
+            throw std::runtime_error("Model snapshot has an inconsistent adjacency.");
+        }
+    }
+    for (size_t i = 0; i < node_count; ++i) {
+        if (offsets[i] > offsets[i + 1]) throw std::runtime_error("Model snapshot has an inconsistent adjacency.");
+    }
+    for (uint32_t neighbor : neighbors) {
+        if (neighbor >= node_count) throw std::runtime_error("Model snapshot has an inconsistent adjacency.");
+    }
+}
+
+Header readHeader(const MappedFile& file) {
+    if (file.size() < sizeof(Header)) {
+        throw std::runtime_error("Model snapshot is truncated.");
+    }
+    Header header;
+    std::memcpy(&header, file.data(), sizeof(Header));
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0) {
+        throw std::runtime_error("Not a model snapshot.");
+    }
+    if (header.byte_order != kByteOrderMark) {
+        throw std::runtime_error("Model snapshot was written on a machine with a different byte order.");
+    }
+    if (header.version != ModelSnapshot::kVersion) {
+        throw std::runtime_error("Model snapshot version " + std::to_string(header.version) +
+                                 " is not supported (expected " + std::to_string(ModelSnapshot::kVersion) + ").");
+    }
+    if (header.payload_size != file.size() - sizeof(Header)) {
+        throw std::runtime_error("Model snapshot is truncated.");
+    }
+    return header;
+}
+
+} // namespace
+
+uint64_t ModelSnapshot::hash(const void* data, size_t size) {
+    const auto* bytes = static_cast<const unsigned char*>(data);
+    uint64_t h = 14695981039346656037ull;
+    for (size_t i = 0; i < size; ++i) {
+        h ^= bytes[i];
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+void ModelSnapshot::write(const rTFPGModel& model, uint64_t source_hash, const std::string& path) {
+    const auto& signals = model.getSignals();
+    const auto& nodes = model.getNodes();
+    const auto& node_records = model.getNodeRecords();
+    const auto& edges = model.getEdges();
+    const CompiledGraph& graph = model.getGraph();
+
+    // Records reference strings by pool position, so the pool is filled first and written ahead of them.
+    StringPool pool;
+    Writer records;
+    for (const Signal& signal : signals) {
+        records.put(pool.add(signal.id));
+        records.put(pool.add(signal.source_name));
+        records.put(pool.add(signal.type));
+        records.put(pool.add(signal.units));
+        records.put(signal.range_min);
+        records.put(signal.range_max);
+    }
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        const Node& node = nodes[i];
+        const NodeRecord& record = node_records[i];
+        const bool discrepancy = record.type == NodeType::Discrepancy;
+        records.put(pool.add(node.id));
+        records.put(pool.add(node.name));
+        records.put(pool.add(node.description));
+        records.put(static_cast<uint8_t>(discrepancy ? 1 : 0));
+        records.put(static_cast<uint8_t>(!discrepancy ? kNoGate : (record.gate_type == GateType::AND ? kGateAnd : kGateOr)));
+        records.put(static_cast<uint8_t>(record.has_predicate ? 1 : 0));
+        records.put(static_cast<uint8_t>(0));
+        records.put(static_cast<int32_t>(record.criticality_level));
+        if (record.has_predicate) {
+            std::string signal_ref = record.signal_index >= 0 ? signals[static_cast<size_t>(record.signal_index)].id : "";
+            records.put(pool.add(signal_ref));
+            records.put(pool.add(comparisonOpSymbol(record.comparison)));
+        } else {
+            records.put(uint32_t{0});
+            records.put(uint32_t{0});
+        }
+        records.put(record.has_predicate ? record.threshold : 0.0);
+    }
+    for (const Edge& edge : edges) {
+        records.put(pool.add(edge.from));
+        records.put(pool.add(edge.to));
+        records.put(static_cast<int32_t>(edge.time_min_ms));
+        records.put(static_cast<int32_t>(edge.time_max_ms));
+    }
+    records.align();
+    writeCsr(records, graph.m_forward.offsets, graph.m_forward.neighbors, graph.m_forward.time_min_ms, graph.m_forward.time_max_ms);
+    writeCsr(records, graph.m_reverse.offsets, graph.m_reverse.neighbors, graph.m_reverse.time_min_ms, graph.m_reverse.time_max_ms);
+
+    Writer payload;
+    std::vector<uint32_t> string_offsets(1, 0);
+    for (const std::string& text : pool.strings()) {
+        string_offsets.push_back(string_offsets.back() + static_cast<uint32_t>(text.size()));
+    }
+    payload.putArray(string_offsets);
+    for (const std::string& text : pool.strings()) payload.putBytes(text);
+    payload.align();
+    const auto& record_bytes = records.bytes();
+    std::vector<unsigned char> bytes = payload.bytes();
+    bytes.insert(bytes.end(), record_bytes.begin(), record_bytes.end());
+
+    Header header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.byte_order = kByteOrderMark;
+    header.source_hash = source_hash;
+    header.payload_size = bytes.size();
+    header.payload_checksum = hash(bytes.data(), bytes.size());
+    header.string_count = static_cast<uint32_t>(pool.strings().size());
+    header.signal_count = static_cast<uint32_t>(signals.size());
+    header.node_count = static_cast<uint32_t>(nodes.size());
+    header.edge_count = static_cast<uint32_t>(edges.size());
+    header.graph_edge_count = static_cast<uint32_t>(graph.edgeCount());
+
+    // Written under a temporary name and renamed, so readers never map a half-written snapshot.
+    const std::string temp_path = path + ".tmp";
+    {
+        std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+        if (!out) throw std::runtime_error("Could not write model snapshot: " + temp_path);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+        if (!out) throw std::runtime_error("Could not write model snapshot: " + temp_path);
+    }
+    std::error_code error;
+    std::filesystem::rename(temp_path, path, error);
+    if (error) {
+        std::filesystem::remove(temp_path, error);
+        throw std::runtime_error("Could not write model snapshot: " + path);
+    }
+}
+
+rTFPGModel ModelSnapshot::load(const std::string& path) {
+    MappedFile file(path);
+    return decode(file, path);
+}
+
+rTFPGModel ModelSnapshot::decode(const MappedFile& file, const std::string& path) {
+    Header header = readHeader(file);
+    const unsigned char* payload = file.data() + sizeof(Header);
+    if (hash(payload, header.payload_size) != header.payload_checksum) {
+        throw std::runtime_error("Model snapshot checksum mismatch: " + path);
+    }
+    Reader in(payload, header.payload_size);
+
+    std::vector<uint32_t> string_offsets;
+    in.getArray(string_offsets, header.string_count + size_t{1});
+    const char* chars = in.getBytes(string_offsets.back());
+    in.align();
+    std::vector<std::string> strings;
+    strings.reserve(header.string_count);
+    for (uint32_t i = 0; i < header.string_count; ++i) {
+        if (string_offsets[i] > string_offsets[i + 1]) throw std::runtime_error("Model snapshot has a corrupt string table.");
+        strings.emplace_back(chars + string_offsets[i], string_offsets[i + 1] - string_offsets[i]);
+    }
+    auto text = [&strings](uint32_t index) -> const std::string& {
+        if (index >= strings.size()) throw std::runtime_error("Model snapshot has a corrupt string reference.");
+        return strings[index];
+    };
+
+    std::vector<Signal> signals(header.signal_count);
+    for (Signal& signal : signals) {
+        signal.id = text(in.get<uint32_t>());
+        signal.source_name = text(in.get<uint32_t>());
+        signal.type = text(in.get<uint32_t>());
+        signal.units = text(in.get<uint32_t>());
+        signal.range_min = in.get<double>();
+        signal.range_max = in.get<double>();
+    }
+
+    std::vector<NodeDefinition> nodes(header.node_count);
+    for (NodeDefinition& node : nodes) {
+        node.id = text(in.get<uint32_t>());
+        node.name = text(in.get<uint32_t>());
+        node.description = text(in.get<uint32_t>());
+        node.type = in.get<uint8_t>() == 0 ? NodeType::FailureMode : NodeType::Discrepancy;
+        uint8_t gate = in.get<uint8_t>();
+        if (gate != kNoGate) node.gate_type = gate == kGateAnd ? GateType::AND : GateType::OR;
+        bool has_predicate = in.get<uint8_t>() != 0;
+        in.get<uint8_t>();
+        node.criticality_level = in.get<int32_t>();
+        uint32_t signal_ref = in.get<uint32_t>();
+        uint32_t op = in.get<uint32_t>();
+        double threshold = in.get<double>();
+        if (has_predicate) {
+            Predicate predicate;
+            predicate.signal_ref = text(signal_ref);
+            predicate.op = text(op);
+            predicate.threshold = threshold;
+            try {
+                predicate.comparison = parseComparisonOp(predicate.op);
+            } catch (const std::invalid_argument& e) {
+                throw std::runtime_error(std::string("Model snapshot is invalid: ") + e.what());
+            }
+            node.predicate = predicate;
+        }
+    }
+
+    std::vector<Edge> edges(header.edge_count);
+    for (Edge& edge : edges) {
+        edge.from = text(in.get<uint32_t>());
+        edge.to = text(in.get<uint32_t>());
+        edge.time_min_ms = in.get<int32_t>();
+        edge.time_max_ms = in.get<int32_t>();
+    }
+    in.align();
+
+    CompiledGraph graph;
+    graph.m_node_count = header.node_count;
+    readCsr(in, header.node_count, header.graph_edge_count, graph.m_forward.offsets, graph.m_forward.neighbors,
+            graph.m_forward.time_min_ms, graph.m_forward.time_max_ms);
+    readCsr(in, header.node_count, header.graph_edge_count, graph.m_reverse.offsets, graph.m_reverse.neighbors,
+            graph.m_reverse.time_min_ms, graph.m_reverse.time_max_ms);
+    // The engine runs partitions in parallel on the strength of these, so they are not taken from the
+    // file: recomputing them from the bounds-checked adjacency is linear and cannot disagree with it.
+    graph.condense();
+    graph.partition();
+
+    // Duplicate IDs, dangling signal or node references, bad intervals, an adjacency not matching the edges.
+    try {
+        return rTFPGModel(std::move(signals), std::move(nodes), std::move(edges), std::move(graph));
+    } catch (const std::invalid_argument& e) {
+        throw std::runtime_error(std::string("Model snapshot is invalid: ") + e.what());
+    }
+}
+
+std::optional<rTFPGModel> ModelSnapshot::loadIfFresh(const std::string& path, uint64_t source_hash) {
+    std::error_code error;
+    if (!std::filesystem::exists(path, error)) return std::nullopt;
+    try {
+        MappedFile file(path);
+        if (readHeader(file).source_hash != source_hash) return std::nullopt;
+        return decode(file, path);
+    } catch (const std::exception&) {
+        return std::nullopt; // Unreadable or outdated cache: the caller rebuilds it from the JSON
+    }
+}
+
+std::string ModelSnapshot::cachePathFor(const std::string& json_path) {
+    const std::string extension = ".json";
+    if (json_path.size() > extension.size() &&
+        json_path.compare(json_path.size() - extension.size(), extension.size(), extension) == 0) {
+        return json_path.substr(0, json_path.size() - extension.size()) + ".rtfpgc";
+    }
+    return json_path + ".rtfpgc";
+}
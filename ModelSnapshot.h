@@ -0,0 +1,64 @@
+#ifndef MODEL_SNAPSHOT_H
+#define MODEL_SNAPSHOT_H
+
+/**
+ * @class ModelSnapshot
+ * @brief Versioned, checksummed binary snapshot of a fully compiled rTFPGModel.
+ *
+ * A snapshot holds the model's string table, signals, nodes (with predicates and criticality
+ * levels), the edge list and the compiled forward/reverse CSR adjacency. Loading memory-maps the
+ * file, verifies the header and checksum, and copies the records and adjacency arrays out of the
+ * mapping, which is closed once the model is built; no JSON is parsed and no adjacency is rebuilt.
+ * Snapshot-local string indices are remapped onto SymbolTable::shared() on load. Since a snapshot that
+ * passes its checksum may still come from a faulty or older writer, the loaded model then gets the
+ * same reference checks as a JSON load, and both adjacencies must hold exactly the listed edges.
+ * The strongly and weakly connected components are not stored: they are recomputed from the
+ * adjacency on load, in linear time.
+ *
+ * Snapshots are written in the byte order of the machine that wrote them and are rejected on a
+ * machine with a different byte order. Any format change must bump kVersion.
+ */
+
+#include "rTFPGModel.h"
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+class MappedFile;
+
+class ModelSnapshot {
+public:
+    static constexpr uint32_t kVersion = 5;
+
+    /// @brief 64-bit FNV-1a hash. Used for the JSON source fingerprint and the payload checksum.
+    static uint64_t hash(const void* data, size_t size);
+
+    /**
+     * @brief Writes the snapshot of a model.
+     * @param source_hash Fingerprint of the JSON the model was loaded from (see loadIfFresh()).
+     * @throws std::runtime_error if the file cannot be written.
+     */
+    static void write(const rTFPGModel& model, uint64_t source_hash, const std::string& path);
+
+    /**
+     * @brief Loads a snapshot.
+     * @throws std::runtime_error if the file is missing, truncated, corrupted, of another version, or
+     *         fails the structural checks described above.
+     */
+    static rTFPGModel load(const std::string& path);
+
+    /**
+     * @brief Loads a cached snapshot if it is intact and was written for this JSON fingerprint.
+     * @return The model, or std::nullopt if the cache is missing, stale or unreadable.
+     */
+    static std::optional<rTFPGModel> loadIfFresh(const std::string& path, uint64_t source_hash);
+
+    /// @brief Default cache location for a JSON model: the same path with a ".rtfpgc" extension.
+    static std::string cachePathFor(const std::string& json_path);
+
+private:
+    static rTFPGModel decode(const MappedFile& file, const std::string& path);
+};
+
+#endif // MODEL_SNAPSHOT_H
@@ -7,50 +7,36 @@
 #include <limits>
 
 // Constructor for the PrognosisManager.
-PrognosisManager::PrognosisManager(const rTFPGModel& model) : m_model(model) {
-    // Pre-builds the graph structure for efficient traversal during prognosis calculations.
-    buildGraph();
-}
-
-// Pre-processes the model to build efficient data structures for graph traversal.
-void PrognosisManager::buildGraph() {
-    // Cache nodes in a map for O(1) lookup by ID.
-    for (const auto& node : m_model.getNodes()) {
-        m_node_map[node.id] = node;
-    }
-
-    // Build an adjacency list representation of the graph.
-    // Each entry maps a node ID to a vector of its children and the minimum propagation time.
-    for (const auto& edge : m_model.getEdges()) {
-        m_adj[edge.from].push_back({edge.to, edge.time_min_ms});
-    }
-}
+// Graph traversals use the model's compiled CSR adjacency (rTFPGModel::getGraph()).
+PrognosisManager::PrognosisManager(const rTFPGModel& model) : m_model(model) {}
 
 // REQ-PROG-01: Hypothesis Plausibility
 // Calculates the plausibility of a given failure hypothesis.
 // Plausibility is the ratio of observed symptoms to expected symptoms for that failure.
 double PrognosisManager::calculatePlausibility(const std::string& hypothesisId, 
-                                               const std::unordered_map<std::string, NodeState>& nodeStates) {
-    // Queue stores {node_id, chain_is_valid}
+                                               const std::vector<NodeState>& nodeStates) {
+    int hypothesis = m_model.getNodeIndex(hypothesisId);
+    if (hypothesis < 0) return 0.0;
+    const auto& nodes = m_model.getNodeRecords();
+
+    // Queue stores {node_index, chain_is_valid}
     // chain_is_valid: true if the path from hypothesis to here is unbroken (active or pending).
-    std::queue<std::pair<std::string, bool>> q;
-    q.push({hypothesisId, true}); 
+    std::queue<std::pair<size_t, bool>> q;
+    q.push({static_cast<size_t>(hypothesis), true}); 
 
-    std::set<std::string> visited;
-    visited.insert(hypothesisId);
+    std::vector<bool> visited(nodes.size(), false);
+    visited[static_cast<size_t>(hypothesis)] = true;
 
     int totalExpected = 0; // Counter for all symptoms expected to be caused by the hypothesis.
     int consistent = 0;    // Counter for expected symptoms that are actually active.
 
     while (!q.empty()) {
-        auto [currId, chainValid] = q.front();
+        auto [curr, chainValid] = q.front();
         q.pop();
 
         // Determine if current node is active
-        bool isActive = (currId == hypothesisId);
-        if (nodeStates.count(currId) && nodeStates.at(currId).is_active) {
-            isActive = true;
-        }
+        bool isActive = (curr == static_cast<size_t>(hypothesis)) || nodeStates[curr].is_active;
+        bool isDiscrepancy = nodes[curr].type == NodeType::Discrepancy;
 
         bool nextChainValid = false;
 
@@ -58,7 +44,7 @@ double PrognosisManager::calculatePlausibility(const std::string& hypothesisId,
             // Node is active. The chain is confirmed valid at this point.
             nextChainValid = true;
             
-            if (m_node_map.count(currId) && m_node_map.at(currId).type == NodeType::Discrepancy) {
+            if (isDiscrepancy) {
                 totalExpected++;
                 consistent++;
             }
@@ -71,7 +57,7 @@ double PrognosisManager::calculatePlausibility(const std::string& hypothesisId,
             } else {
                 // Parent was broken/unreachable. This node is UNREACHABLE.
                 // Penalize.
-                if (m_node_map.count(currId) && m_node_map.at(currId).type == NodeType::Discrepancy) {
+                if (isDiscrepancy) {
                     totalExpected++;
                 }
                 nextChainValid = false;
@@ -79,12 +65,10 @@ double PrognosisManager::calculatePlausibility(const std::string& hypothesisId,
         }
 
         // Traverse to all children of the current node.
-        if (m_adj.count(currId)) {
-            for (const auto& edge : m_adj.at(currId)) {
-                if (visited.find(edge.first) == visited.end()) {
-                    visited.insert(edge.first);
-                    q.push({edge.first, nextChainValid});
-                }
+        for (const auto& edge : m_model.getGraph().children(curr)) {
+            if (!visited[edge.node_index]) {
+                visited[edge.node_index] = true;
+                q.push({edge.node_index, nextChainValid});
             }
         }
     }
@@ -97,75 +81,150 @@ double PrognosisManager::calculatePlausibility(const std::string& hypothesisId,
 // REQ-PROG-02 & REQ-PROG-03: Time-To-Criticality (TTC)
 // TTC is the shortest time from the current state to the activation of a node
 // that meets or exceeds the specified criticality threshold.
-// This is implemented using Dijkstra's algorithm.
-PrognosisResult PrognosisManager::calculateTTC(const std::unordered_map<std::string, NodeState>& nodeStates, 
+// No edge joins two partitions (weakly connected components) of the graph, so only partitions holding
+// both an active node and a critical node are searched, each on its own (and possibly concurrently).
+// On an acyclic model a partition is a single pass in topological order (O(V + E), no heap);
+// otherwise it is searched using Dijkstra's algorithm.
+PrognosisResult PrognosisManager::calculateTTC(const std::vector<NodeState>& nodeStates, 
                                       int criticalityThreshold, double current_time) {
-    // Min-priority queue for Dijkstra's algorithm. Stores pairs of {accumulated_time, node_id}.
-    using P = std::pair<double, std::string>;
-    std::priority_queue<P, std::vector<P>, std::greater<P>> pq;
-    // Map to store the minimum time to reach each node.
-    std::unordered_map<std::string, double> min_dist;
-
-    // Initialize the algorithm with the "State Front", which consists of all currently active nodes.
+    const auto& nodes = m_model.getNodes();
+    const CompiledGraph& graph = m_model.getGraph();
+    const double unreached = std::numeric_limits<double>::infinity();
+    // REQ-MOD-04: Criticality front membership, an O(1) test per settled node.
+    const BitSet& critical = m_model.getCriticalityMask(criticalityThreshold);
+    IndexSpan front = m_model.GetCriticalityFront(criticalityThreshold);
+    if (front.empty()) return {unreached, ""}; // Nothing to reach
+
+    // Minimum time to reach each node, indexed by dense node index. Partitions write disjoint entries.
+    std::vector<double> min_dist(nodes.size(), unreached);
+
+    // Initialize with the "State Front", which consists of all currently active nodes.
     // The starting time for each is its recorded activation time.
-    for (const auto& pair : nodeStates) {
-        if (pair.second.is_active) {
-            double start_time = pair.second.activation_time_ms;
-            pq.push({start_time, pair.first});
-            min_dist[pair.first] = start_time;
+    enum : uint8_t { kHasCritical = 1, kHasActive = 2 };
+    std::vector<uint8_t> partition_flags(graph.partitionCount(), 0);
+    for (size_t node : front) partition_flags[graph.partitionOf(node)] |= kHasCritical;
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        if (nodeStates[i].is_active) {
+            min_dist[i] = nodeStates[i].activation_time_ms;
+            partition_flags[graph.partitionOf(i)] |= kHasActive;
+        }
+    }
+    std::vector<size_t> searched;
+    size_t work = 0;
+    for (size_t p = 0; p < partition_flags.size(); ++p) {
+        if (partition_flags[p] == (kHasCritical | kHasActive)) {
+            searched.push_back(p);
+            work += graph.partitionMembers(p).size();
         }
     }
 
-    // Run Dijkstra's algorithm.
-    while (!pq.empty()) {
-        double d = pq.top().first;
-        std::string u = pq.top().second;
-        pq.pop();
-
-        // Check if we have reached a node on the "Criticality Front".
-        if (m_node_map.count(u) && m_node_map.at(u).criticality_level >= criticalityThreshold) {
-            // If so, we have found a path to a critical failure.
-            // Only return if this node is NOT already active (we want future prognosis).
-            if (!nodeStates.count(u) || !nodeStates.at(u).is_active) {
-                double ttc = d - current_time;
-                return {ttc, u};
+    using P = std::pair<double, size_t>;
+    using MinQueue = std::priority_queue<P, std::vector<P>, std::greater<P>>;
+
+    // Explore neighbors (children in the graph) of a node whose distance d is final.
+    auto relaxChildren = [&](size_t u, double d, MinQueue* pq) {
+        for (const auto& edge : graph.children(u)) {
+            size_t v = edge.node_index;
+
+            // If the downstream node is already active, we must respect its observed
+            // activation time and not overwrite it with a theoretical prediction.
+            if (nodeStates[v].is_active) {
+                continue;
             }
-            // If it is active, we continue searching downstream for the next critical event.
-        }
 
-        // Optimization: if we found a shorter path to `u` already, skip.
-        if (min_dist.count(u) && d > min_dist.at(u)) continue;
+            // The weight of the edge is the minimum propagation time.
+            int weight = edge.time_min_ms; // t_propagation
+            double arrival_time = d + weight;
 
-        // Explore neighbors (children in the graph).
-        if (m_adj.count(u)) {
-            for (const auto& edge : m_adj.at(u)) {
-                std::string v = edge.first;
+            // Filter out paths that predict activation in the past.
+            // This prevents prognosis stagnation when a predicted path fails to trigger (e.g. AND-gate).
+            if (arrival_time < current_time) {
+                continue;
+            }
 
-                // If the downstream node is already active, we must respect its observed
-                // activation time and not overwrite it with a theoretical prediction.
-                if (nodeStates.count(v) && nodeStates.at(v).is_active) {
-                    continue;
-                }
+            // If we found a new shorter path to `v`, update its distance and add it to the queue.
+            if (min_dist[v] > arrival_time) {
+                min_dist[v] = arrival_time;
+                if (pq) pq->push({min_dist[v], v});
+            }
+        }
+    };
+
+    // Distance of the nearest inactive critical node of one partition. Every node at or below that
+    // distance is left with its final min_dist, which the tie replay below relies on.
+    auto searchPartition = [&](size_t partition) {
+        double target = unreached;
+        if (graph.isAcyclic()) {
+            // Every parent of a node comes before it, so its distance is final when it is reached.
+            for (uint32_t u : graph.partitionMembers(partition)) {
+                double d = min_dist[u];
+                if (d == unreached) continue;
+                if (critical.test(u) && !nodeStates[u].is_active) target = std::min(target, d);
+                relaxChildren(u, d, nullptr);
+            }
+            return target;
+        }
 
-                // The weight of the edge is the minimum propagation time.
-                int weight = edge.second; // t_propagation
-                double arrival_time = d + weight;
+        // Min-priority queue for Dijkstra's algorithm. Stores pairs of {accumulated_time, node_index}.
+        MinQueue pq;
+        for (uint32_t u : graph.partitionMembers(partition)) {
+            if (nodeStates[u].is_active) pq.push({min_dist[u], u});
+        }
+        // Keep settling nodes at the critical distance once it is known, for the tie replay.
+        while (!pq.empty() && pq.top().first <= target) {
+            double d = pq.top().first;
+            size_t u = pq.top().second;
+            pq.pop();
 
-                // Filter out paths that predict activation in the past.
-                // This prevents prognosis stagnation when a predicted path fails to trigger (e.g. AND-gate).
-                if (arrival_time < current_time) {
-                    continue;
-                }
+            // Check if we have reached a node on the "Criticality Front". Only an inactive node
+            // counts (we want future prognosis); past an active one the search continues downstream.
+            if (critical.test(u) && !nodeStates[u].is_active) target = std::min(target, d);
 
-                // If we found a new shorter path to `v`, update its distance and add it to the queue.
-                if (!min_dist.count(v) || min_dist[v] > arrival_time) {
-                    min_dist[v] = arrival_time;
-                    pq.push({min_dist[v], v});
-                }
+            // Optimization: if we found a shorter path to `u` already, skip.
+            if (d > min_dist[u]) continue;
+
+            relaxChildren(u, d, &pq);
+        }
+        return target;
+    };
+
+    std::vector<double> partition_target(searched.size(), unreached);
+    m_workers.parallelFor(searched.size(), work, [&](size_t i) { partition_target[i] = searchPartition(searched[i]); });
+
+    double target = unreached;
+    for (double t : partition_target) target = std::min(target, t);
+    if (target == unreached) return {unreached, ""}; // No critical node reachable
+
+    // Several critical nodes, possibly in different partitions, may be equally near. Replay the pop
+    // order of a single Dijkstra search over the nodes at that distance so the same one is reported:
+    // a node is queued once a nearer parent reached it, or when a parent at the same distance is
+    // popped (zero-delay edge); among queued nodes the lowest node ID pops first, as in the original
+    // {time, node ID} queue.
+    const std::vector<uint32_t>& id_ranks = m_model.getNodeIdRanks();
+    using Ranked = std::pair<uint32_t, size_t>; // {ID rank, node index}
+    std::priority_queue<Ranked, std::vector<Ranked>, std::greater<Ranked>> ready;
+    for (size_t i = 0; i < searched.size(); ++i) {
+        if (partition_target[i] != target) continue;
+        for (uint32_t v : graph.partitionMembers(searched[i])) {
+            if (min_dist[v] != target) continue;
+            bool queued = nodeStates[v].is_active;
+            for (const auto& edge : graph.parents(v)) {
+                queued = queued || (min_dist[edge.node_index] < target && min_dist[edge.node_index] + edge.time_min_ms == target);
             }
+            if (queued) ready.push({id_ranks[v], v});
         }
     }
-
-    // If the loop completes without finding a path to a critical node, return -1.
-    return {std::numeric_limits<double>::infinity(), ""}; // No critical node reachable
-}
\ No newline at end of file
+    std::vector<char> popped(nodes.size(), 0);
+    while (!ready.empty()) {
+        size_t u = ready.top().second;
+        ready.pop();
+        if (popped[u]) continue;
+        popped[u] = 1;
+        if (critical.test(u) && !nodeStates[u].is_active) return {target - current_time, nodes[u].id};
+        for (const auto& edge : graph.children(u)) {
+            size_t v = edge.node_index;
+            if (edge.time_min_ms == 0 && !nodeStates[v].is_active && min_dist[v] == target) ready.push({id_ranks[v], v});
+        }
+    }
+    return {unreached, ""}; // Unreachable: the node that set the target distance is queued above
+}
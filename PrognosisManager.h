@@ -12,10 +12,12 @@
 
 #include "rTFPGModel.h"
 #include "LogicEngine.h" // For NodeState
+#include "WorkerPool.h"
 #include <string>
 #include <vector>
 #include <unordered_map>
 #include <utility>
+#include <algorithm>
 
 struct PrognosisResult {
     double ttc;
@@ -28,26 +30,33 @@ public:
 
     /**
      * @brief REQ-PROG-01: Calculates Hypothesis Plausibility.
+     * @param nodeStates Node states indexed by dense node index (LogicEngine::getDenseNodeStates()).
      * @return Ratio of (currently active discrepancy nodes) / (total reachable discrepancy nodes)
      *         starting from the hypothesis node.
      */
     double calculatePlausibility(const std::string& hypothesisId, 
-                                 const std::unordered_map<std::string, NodeState>& nodeStates);
+                                 const std::vector<NodeState>& nodeStates);
 
     /**
      * @brief REQ-PROG-02 & REQ-PROG-03: Calculates Time-To-Criticality (TTC).
+     * @param nodeStates Node states indexed by dense node index (LogicEngine::getDenseNodeStates()).
      * @return The minimum time (ms) from any currently active node to any node with 
      *         criticality_level >= criticalityThreshold. Returns -1.0 if unreachable.
      */
-    PrognosisResult calculateTTC(const std::unordered_map<std::string, NodeState>& nodeStates, 
+    PrognosisResult calculateTTC(const std::vector<NodeState>& nodeStates, 
                         int criticalityThreshold, double current_time);
 
+    /**
+     * @brief Searches up to this many graph partitions concurrently in calculateTTC().
+     * @param count Worker threads, the calling thread included. 1 (the default) stays single-threaded.
+     *        The result is the same for any count. The helper threads persist for the manager's
+     *        lifetime; searches over fewer than WorkerPool::kMinParallelWork nodes run inline.
+     */
+    void setWorkerThreads(size_t count) { m_workers.setWorkerCount(count); }
+
 private:
     const rTFPGModel& m_model;
-    std::unordered_map<std::string, Node> m_node_map;
-    std::unordered_map<std::string, std::vector<std::pair<std::string, int>>> m_adj; // ID -> {neighbor, time}
-
-    void buildGraph();
+    WorkerPool m_workers;
 };
 
 #endif // PROGNOSIS_MANAGER_H
\ No newline at end of file
@@ -13,19 +13,23 @@ double RefinementOptimizer::calculateDiagnosisError(const std::string& targetNod
     if (dataset.empty()) return 0.0;
 
     int misclassifications = 0;
+    NullEventSink silent_sink;
 
     // Iterate through each labeled trace in the dataset.
     for (const auto& trace : dataset) {
         // Instantiate a temporary engine to run a diagnosis on this specific trace.
         LogicEngine engine(m_model, *trace.ingestor);
+        // Only the final node states matter here; skip formatting activation events.
+        engine.setEventSink(silent_sink);
         // Run the diagnosis to get the active hypotheses and node states.
-        auto active_nodes = engine.findActiveHypotheses(); // This runs the logic
-        const auto& node_states = engine.getNodeStates();
+        engine.findActiveHypotheses(); // This runs the logic
+        const auto& node_states = engine.getDenseNodeStates();
 
         // Check if the target node was activated in the simulation.
         bool is_active = false;
-        if (node_states.count(targetNodeId)) {
-            is_active = node_states.at(targetNodeId).is_active;
+        int target_index = m_model.getNodeIndex(targetNodeId);
+        if (target_index >= 0) {
+            is_active = node_states[static_cast<size_t>(target_index)].is_active;
         }
 
         // Compare the simulation result with the ground truth from the labeled trace.
@@ -42,23 +46,26 @@ double RefinementOptimizer::calculateDiagnosisError(const std::string& targetNod
 // Finds all ancestor nodes of a given node, which form the basis for refinement.
 std::set<std::string> RefinementOptimizer::getMinimalCutSet(const std::string& nodeId) {
     std::set<std::string> mcs;
-    std::queue<std::string> q;
-    q.push(nodeId);
-    std::set<std::string> visited;
-    visited.insert(nodeId);
+    int start = m_model.getNodeIndex(nodeId);
+    if (start < 0) return mcs;
+
+    const auto& nodes = m_model.getNodes();
+    const CompiledGraph& graph = m_model.getGraph();
+    std::queue<size_t> q;
+    q.push(static_cast<size_t>(start));
+    std::vector<bool> visited(nodes.size(), false);
+    visited[static_cast<size_t>(start)] = true;
 
     // Perform a backward Breadth-First Search (BFS) to find all ancestors.
     while (!q.empty()) {
-        std::string curr = q.front();
+        size_t curr = q.front();
         q.pop();
 
-        for (const auto& edge : m_model.getEdges()) {
-            if (edge.to == curr) {
-                mcs.insert(edge.from);
-                if (visited.find(edge.from) == visited.end()) {
-                    visited.insert(edge.from);
-                    q.push(edge.from);
-                }
+        for (const auto& edge : graph.parents(curr)) {
+            mcs.insert(nodes[edge.node_index].id);
+            if (!visited[edge.node_index]) {
+                visited[edge.node_index] = true;
+                q.push(edge.node_index);
             }
         }
     }
@@ -69,7 +76,7 @@ std::set<std::string> RefinementOptimizer::getMinimalCutSet(const std::string& n
 // This is the core of the model refinement algorithm. It attempts to improve the model
 // by adding or modifying nodes and edges to reduce the Diagnosis Error.
 void RefinementOptimizer::refine(const std::string& p_id, 
-                                 const std::vector<Node>& candidateSetH, 
+                                 const std::vector<NodeDefinition>& candidateSetH, 
                                  const std::vector<LabeledTrace>& dataset) {
     
     // Calculate the current diagnosis error for the node to be refined.
@@ -81,9 +88,10 @@ void RefinementOptimizer::refine(const std::string& p_id,
 
     // 1. Successor Selection: Try to find a successor node with a lower or equal DE.
     // If found, recurse on that successor. This prioritizes refining downstream nodes first.
-    for (const auto& edge : m_model.getEdges()) {
-        if (edge.from == p_id) {
-            std::string d_prime_id = edge.to;
+    int p_index = m_model.getNodeIndex(p_id);
+    if (p_index >= 0) {
+        for (const auto& edge : m_model.getGraph().children(static_cast<size_t>(p_index))) {
+            std::string d_prime_id = m_model.getNodes()[edge.node_index].id;
             double successorDE = calculateDiagnosisError(d_prime_id, dataset);
             
             if (successorDE <= currentDE) {
@@ -97,12 +105,14 @@ void RefinementOptimizer::refine(const std::string& p_id,
     // 2. Edge Addition (Internal): Try adding an edge from an existing node to the current node `p`.
     // This explores if a missing causal link can explain the error.
     std::set<std::string> mcs = getMinimalCutSet(p_id);
-    for (const auto& node : m_model.getNodes()) {
+    const auto& records = m_model.getNodeRecords();
+    for (size_t i = 0; i < m_model.getNodes().size(); ++i) {
+        const Node& node = m_model.getNodes()[i];
         // Consider adding an edge from another discrepancy node that is not already an ancestor.
-        if (node.type == NodeType::Discrepancy && node.id != p_id && mcs.find(node.id) == mcs.end()) {
-            // Tentatively add the new edge.
+        if (records[i].type == NodeType::Discrepancy && node.id != p_id && mcs.find(node.id) == mcs.end()) {
+            // Tentatively add the new edge. An existing edge is no change to evaluate.
             Edge newEdge = {node.id, p_id, 0, 1000}; // Default interval
-            m_model.addEdge(newEdge);
+            if (!m_model.addEdge(newEdge)) continue;
 
             // Check if this change reduces the diagnosis error.
             double newDE = calculateDiagnosisError(p_id, dataset);
@@ -121,15 +131,13 @@ void RefinementOptimizer::refine(const std::string& p_id,
     // 3. Node Expansion (External): Try adding a new candidate node from `candidateSetH` to the model.
     for (const auto& d_prime : candidateSetH) {
         // Check if d_prime is already in the graph to avoid duplicates in this simplified logic
-        bool exists = false;
-        for(const auto& n : m_model.getNodes()) if(n.id == d_prime.id) exists = true;
-        if(exists) continue;
+        if (m_model.getNodeIndex(d_prime.id) >= 0) continue;
 
         // Add the new candidate node to the model.
         m_model.addNode(d_prime);
         // Case A: Create an edge from `p` to the new node `d_prime`.
         Edge edgeA = {p_id, d_prime.id, 0, 1000};
-        m_model.addEdge(edgeA);
+        bool addedA = m_model.addEdge(edgeA);
 
         // Check if this new structure reduces the DE of the new node `d_prime`.
         double de_d_prime = calculateDiagnosisError(d_prime.id, dataset);
@@ -140,21 +148,25 @@ void RefinementOptimizer::refine(const std::string& p_id,
              refine(d_prime.id, candidateSetH, dataset); // Recurse on d'
              return;
         } else {
-            // Revert Case A.
-            m_model.removeEdge(p_id, d_prime.id);
+            // Revert Case A, unless the edge was already in the model.
+            if (addedA) m_model.removeEdge(p_id, d_prime.id);
             // Don't remove node yet, might be used in Case B
         }
 
         // Case B: Create an edge from a predecessor of `p` to the new node `d_prime`.
         bool improvementFound = false;
+        // Copied out: the edge additions below invalidate the graph.
         std::vector<std::string> predecessors;
-        for(const auto& e : m_model.getEdges()) {
-            if(e.to == p_id) predecessors.push_back(e.from);
+        int p_pos = m_model.getNodeIndex(p_id);
+        if (p_pos >= 0) {
+            for (const auto& e : m_model.getGraph().parents(static_cast<size_t>(p_pos))) {
+                predecessors.push_back(m_model.getNodes()[e.node_index].id);
+            }
         }
 
         for(const auto& v_id : predecessors) {
             Edge edgeB = {v_id, d_prime.id, 0, 1000};
-            m_model.addEdge(edgeB);
+            if (!m_model.addEdge(edgeB)) continue;
             
             // Requirement: "If this reduces the DE of p"
             // Note: Adding an edge to d' doesn't inherently change p's logic unless p depends on d'.
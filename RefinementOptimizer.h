@@ -46,7 +46,7 @@ public:
      * @param dataset The labeled training data.
      */
     void refine(const std::string& targetNodeId, 
-                const std::vector<Node>& candidateSetH, 
+                const std::vector<NodeDefinition>& candidateSetH, 
                 const std::vector<LabeledTrace>& dataset);
 
 private:
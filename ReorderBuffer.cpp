@@ -0,0 +1,57 @@
+#include "ReorderBuffer.h"
+#include <algorithm>
+#include <utility>
+
+ReorderBuffer::ReorderBuffer(uint64_t max_lateness_ms) : m_max_lateness_ms(max_lateness_ms) {}
+
+// Heap order: std::push_heap keeps the greatest element on top, so "greater" means later.
+bool ReorderBuffer::later(const Entry& a, const Entry& b) {
+    if (a.sample.timestamp_ms != b.sample.timestamp_ms) return a.sample.timestamp_ms > b.sample.timestamp_ms;
+    return a.arrival > b.arrival;
+}
+
+bool ReorderBuffer::push(const DataSample& sample) {
+    m_stats.received++;
+    const uint64_t timestamp = sample.timestamp_ms;
+    if (timestamp < m_newest_timestamp_ms) {
+        m_stats.max_observed_lateness_ms = std::max(m_stats.max_observed_lateness_ms, m_newest_timestamp_ms - timestamp);
+    }
+    if (timestamp < m_watermark_ms) {
+        m_stats.late_dropped++;
+        return false;
+    }
+    if (timestamp < m_newest_timestamp_ms) {
+        m_stats.reordered++;
+    } else {
+        m_newest_timestamp_ms = timestamp;
+        if (timestamp >= m_max_lateness_ms) {
+            m_watermark_ms = std::max(m_watermark_ms, timestamp - m_max_lateness_ms);
+        }
+    }
+
+    m_heap.push_back({sample, m_next_arrival++});
+    std::push_heap(m_heap.begin(), m_heap.end(), later);
+    m_stats.peak_buffered = std::max(m_stats.peak_buffered, m_heap.size());
+    return true;
+}
+
+bool ReorderBuffer::pop(DataSample& sample) {
+    if (m_heap.empty() || m_heap.front().sample.timestamp_ms > m_watermark_ms) return false;
+    sample = takeOldest();
+    return true;
+}
+
+bool ReorderBuffer::flush(DataSample& sample) {
+    if (m_heap.empty()) return false;
+    sample = takeOldest();
+    // Anything older than what has been released can no longer be placed in order.
+    m_watermark_ms = std::max(m_watermark_ms, sample.timestamp_ms);
+    return true;
+}
+
+DataSample ReorderBuffer::takeOldest() {
+    std::pop_heap(m_heap.begin(), m_heap.end(), later);
+    DataSample sample = std::move(m_heap.back().sample);
+    m_heap.pop_back();
+    return sample;
+}
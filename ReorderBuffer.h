@@ -0,0 +1,85 @@
+#ifndef REORDER_BUFFER_H
+#define REORDER_BUFFER_H
+
+/**
+ * @class ReorderBuffer
+ * @brief Restores timestamp order on a telemetry stream whose samples may arrive late.
+ *
+ * The engine evaluates samples in ingestion order, so a sample delivered after a newer one would be
+ * checked against propagation windows with the wrong activation times. This stage holds samples in a
+ * min-heap keyed by timestamp and releases them once the watermark, the newest timestamp seen minus
+ * the configured maximum lateness, has passed them. Samples with equal timestamps keep their arrival
+ * order.
+ *
+ * A sample that arrives behind the watermark can no longer be placed in order and is dropped and
+ * counted. Everything held lies within max_lateness_ms of the newest sample, so memory is bounded by
+ * the stream rate times the lateness, and no sample is delayed by more than the lateness in stream
+ * time. With a lateness of 0 an in-order stream passes straight through.
+ */
+
+#include "SignalIngestor.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/// @brief Counters describing what the reorder stage has seen, for tuning the lateness bound.
+struct ReorderStats {
+    /// Samples passed to push().
+    uint64_t received = 0;
+    /// Samples that arrived behind the watermark and were dropped.
+    uint64_t late_dropped = 0;
+    /// Accepted samples that arrived after a sample with a later timestamp.
+    uint64_t reordered = 0;
+    /// The largest number of samples held at once.
+    size_t peak_buffered = 0;
+    /// The furthest any sample trailed the newest timestamp seen before it, in milliseconds.
+    uint64_t max_observed_lateness_ms = 0;
+};
+
+class ReorderBuffer {
+public:
+    /// @param max_lateness_ms How far behind the newest sample a sample may arrive and still be ordered.
+    explicit ReorderBuffer(uint64_t max_lateness_ms);
+
+    uint64_t getMaxLateness() const { return m_max_lateness_ms; }
+
+    /**
+     * @brief Accepts a sample from the feed.
+     * @return false if the sample arrived behind the watermark and was dropped.
+     */
+    bool push(const DataSample& sample);
+
+    /**
+     * @brief Takes the oldest held sample if the watermark has passed it.
+     * @return false if no sample is ready yet.
+     */
+    bool pop(DataSample& sample);
+
+    /**
+     * @brief Takes the oldest held sample regardless of the watermark, for draining at end of stream.
+     * @return false if the buffer is empty.
+     */
+    bool flush(DataSample& sample);
+
+    size_t size() const { return m_heap.size(); }
+    bool empty() const { return m_heap.empty(); }
+    const ReorderStats& getStats() const { return m_stats; }
+
+private:
+    struct Entry {
+        DataSample sample;
+        uint64_t arrival; // Breaks timestamp ties in arrival order
+    };
+
+    uint64_t m_max_lateness_ms;
+    std::vector<Entry> m_heap; // Min-heap on (timestamp, arrival)
+    uint64_t m_next_arrival = 0;
+    uint64_t m_newest_timestamp_ms = 0;
+    uint64_t m_watermark_ms = 0; // Samples before this have been released or dropped
+    ReorderStats m_stats;
+
+    static bool later(const Entry& a, const Entry& b);
+    DataSample takeOldest();
+};
+
+#endif // REORDER_BUFFER_H
@@ -0,0 +1,79 @@
+#ifndef RING_BUFFER_H
+#define RING_BUFFER_H
+
+/**
+ * @class RingBuffer
+ * @brief FIFO of fixed-size values addressed by absolute sequence number.
+ *
+ * The n-th value pushed (n = 0, 1, 2, ...) lives at slot n & (capacity - 1) of a single
+ * power-of-two array, so the retained values [begin(), end()) form at most two contiguous runs
+ * (see run()). release() drops the oldest values and frees their slots for reuse; a push into a
+ * full buffer doubles the array instead of overwriting, so a value is never lost before it is
+ * released. Once releases keep pace with pushes the footprint stays constant.
+ */
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+template <class T>
+class RingBuffer {
+public:
+    explicit RingBuffer(size_t initial_capacity = 16) {
+        size_t capacity = 1;
+        while (capacity < initial_capacity) capacity <<= 1;
+        m_slots.resize(capacity);
+    }
+
+    /// @brief Sequence number of the oldest retained value.
+    uint64_t begin() const { return m_begin; }
+    /// @brief Sequence number the next push() will get; also the number of values ever pushed.
+    uint64_t end() const { return m_end; }
+    size_t size() const { return static_cast<size_t>(m_end - m_begin); }
+    bool empty() const { return m_begin == m_end; }
+    size_t capacity() const { return m_slots.size(); }
+
+    void push(const T& value) {
+        if (size() == m_slots.size()) grow();
+        m_slots[slot(m_end++)] = value;
+    }
+
+    /// @brief The value with this sequence number, which must lie in [begin(), end()).
+    const T& operator[](uint64_t sequence) const { return m_slots[slot(sequence)]; }
+
+    /**
+     * @brief The longest contiguous run of values starting at sequence, for linear scans.
+     * @return A pointer to the value with this sequence number and the run length, which is
+     *         end() - sequence unless the run wraps around the end of the array.
+     */
+    std::pair<const T*, size_t> run(uint64_t sequence) const {
+        size_t first = slot(sequence);
+        size_t length = std::min(static_cast<size_t>(m_end - sequence), m_slots.size() - first);
+        return {m_slots.data() + first, length};
+    }
+
+    /// @brief Drops every value before sequence (at most up to end()).
+    void release(uint64_t sequence) {
+        if (sequence > m_end) sequence = m_end;
+        if (sequence > m_begin) m_begin = sequence;
+    }
+
+private:
+    std::vector<T> m_slots;
+    uint64_t m_begin = 0;
+    uint64_t m_end = 0;
+
+    size_t slot(uint64_t sequence) const { return static_cast<size_t>(sequence & (m_slots.size() - 1)); }
+
+    void grow() {
+        std::vector<T> slots(m_slots.size() * 2);
+        for (uint64_t sequence = m_begin; sequence < m_end; ++sequence) {
+            slots[static_cast<size_t>(sequence & (slots.size() - 1))] = m_slots[slot(sequence)];
+        }
+        m_slots.swap(slots);
+    }
+};
+
+#endif // RING_BUFFER_H
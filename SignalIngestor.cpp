@@ -1,30 +1,49 @@
 #include "SignalIngestor.h"
+#include <algorithm>
 #include <stdexcept>
 
 // Constructor for SignalIngestor.
-SignalIngestor::SignalIngestor(const nlohmann::json& fault_model) {
+SignalIngestor::SignalIngestor(const nlohmann::json& fault_model, uint64_t horizon_ms) : m_horizon_ms(horizon_ms) {
     // REQ-IN-03: Populate the mapping from the fault model's "signals" array.
     // This pre-populates the ID mapping to ensure known signals are registered from the start.
     if (fault_model.contains("signals") && fault_model["signals"].is_array()) {
         for (const auto& signal : fault_model["signals"]) {
-            std::string source_name = signal["source_name"];
-            // Check if the signal name is already mapped to avoid duplicates.
-            if (m_parameter_to_internal_id.find(source_name) == m_parameter_to_internal_id.end()) {
-                m_parameter_to_internal_id[source_name] = m_next_internal_id;
-                m_internal_id_to_parameter.push_back(source_name);
-                m_next_internal_id++;
-            }
+            registerSignal(signal["source_name"].get<std::string>());
         }
     }
 }
 
+SignalIngestor::SignalIngestor(const rTFPGModel& model) {
+    for (const auto& signal : model.getSignals()) {
+        registerSignal(signal.source_name);
+    }
+    m_horizon_ms = static_cast<uint64_t>(model.getGraph().maxPropagationDelay());
+}
+
+void SignalIngestor::registerSignal(const std::string& name) {
+    Symbol source_name = SymbolTable::shared().intern(name);
+    if (source_name >= m_parameter_to_internal_id.size()) {
+        m_parameter_to_internal_id.resize(static_cast<size_t>(source_name) + 1, -1);
+    }
+    // Check if the signal name is already mapped to avoid duplicates.
+    if (m_parameter_to_internal_id[source_name] < 0) {
+        m_parameter_to_internal_id[source_name] = m_next_internal_id;
+        m_internal_id_to_parameter.push_back(source_name);
+        m_columns.emplace_back();
+        m_next_internal_id++;
+    }
+}
+
 // Gets the internal integer ID for a given string parameter ID.
 int SignalIngestor::getInternalId(const std::string& parameterID) const {
-    auto it = m_parameter_to_internal_id.find(parameterID);
-    if (it != m_parameter_to_internal_id.end()) {
-        return it->second;
+    return getInternalId(SymbolTable::shared().find(parameterID));
+}
+
+int SignalIngestor::getInternalId(Symbol parameter) const {
+    if (parameter < m_parameter_to_internal_id.size()) {
+        return m_parameter_to_internal_id[parameter];
     }
-    return -1; // Return -1 for unknown parameters.
+    return -1; // Return -1 for unknown parameters (including kNoSymbol).
 }
 
 // Gets the string parameter ID for a given internal integer ID.
@@ -32,17 +51,156 @@ const std::string& SignalIngestor::getParameterId(int internalId) const {
     if (internalId < 0 || static_cast<size_t>(internalId) >= m_internal_id_to_parameter.size()) {
         throw std::out_of_range("Internal ID out of range.");
     }
-    return m_internal_id_to_parameter[static_cast<size_t>(internalId)];
+    return SymbolTable::shared().name(m_internal_id_to_parameter[static_cast<size_t>(internalId)]);
+}
+
+const std::string& SignalIngestor::getFaultName(uint64_t sequence) const {
+    Symbol parameter = m_faults[sequence].parameter;
+    return parameter != kNoSymbol ? SymbolTable::shared().name(parameter) : m_fault_names[sequence];
+}
+
+const SignalIngestor::SignalColumns& SignalIngestor::columns(int internalId) const {
+    if (internalId < 0 || static_cast<size_t>(internalId) >= m_columns.size()) {
+        throw std::out_of_range("Internal ID out of range.");
+    }
+    return m_columns[static_cast<size_t>(internalId)];
+}
+
+const RingBuffer<uint64_t>& SignalIngestor::getTimestamps(int internalId) const {
+    return columns(internalId).timestamps;
 }
 
-// Adds a new data sample to the internal buffer.
+const RingBuffer<double>& SignalIngestor::getValues(int internalId) const {
+    return columns(internalId).values;
+}
+
+// Adds a new data sample to its signal's columns or to the fault event log.
 void SignalIngestor::ingest(const DataSample& sample) {
     // REQ-IN-02: This buffer currently stores all samples as they arrive.
     // In a more complex system, this could implement time-grid alignment or other normalization steps.
-    m_samples.push_back(sample);
+    Symbol parameter = SymbolTable::shared().find(sample.parameterID);
+    int internal_id = getInternalId(parameter);
+    if (internal_id >= 0) {
+        appendSignalSample(static_cast<size_t>(internal_id), sample.timestamp_ms, sample.value);
+    } else {
+        // An ID that no model interned is kept locally, so a stream of ad-hoc names does not grow
+        // the process-wide table; assigning into a reused slot keeps its string capacity.
+        static const std::string kInterned;
+        m_latest_timestamp_ms = std::max(m_latest_timestamp_ms, sample.timestamp_ms);
+        m_faults.push({sample.timestamp_ms, sample.value, parameter});
+        m_fault_names.push(parameter == kNoSymbol ? sample.parameterID : kInterned);
+        m_arrivals.push(kFaultChannel);
+    }
+}
+
+void SignalIngestor::ingest(int internalId, uint64_t timestamp_ms, double value) {
+    if (internalId < 0 || static_cast<size_t>(internalId) >= m_columns.size()) {
+        throw std::out_of_range("Internal ID out of range.");
+    }
+    appendSignalSample(static_cast<size_t>(internalId), timestamp_ms, value);
+}
+
+void SignalIngestor::ingest(const DataSample* samples, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        ingest(samples[i]);
+    }
+}
+
+void SignalIngestor::ingest(int internalId, const uint64_t* timestamps_ms, const double* values, size_t count) {
+    if (internalId < 0 || static_cast<size_t>(internalId) >= m_columns.size()) {
+        throw std::out_of_range("Internal ID out of range.");
+    }
+    for (size_t i = 0; i < count; ++i) {
+        appendSignalSample(static_cast<size_t>(internalId), timestamps_ms[i], values[i]);
+    }
+}
+
+void SignalIngestor::appendSignalSample(size_t internalId, uint64_t timestamp_ms, double value) {
+    m_latest_timestamp_ms = std::max(m_latest_timestamp_ms, timestamp_ms);
+    SignalColumns& signal = m_columns[internalId];
+    signal.timestamps.push(timestamp_ms);
+    signal.values.push(value);
+    m_arrivals.push(static_cast<int32_t>(internalId));
+}
+
+// Replays the journal: each entry names the column holding the cursor's next sample.
+bool SignalIngestor::next(IngestCursor& cursor, IngestedSample& sample) const {
+    if (cursor.arrivals < m_watermark.arrivals) {
+        // The journal entries behind the watermark are gone, so the per-signal positions of the
+        // samples in between are unknown; the watermark's own positions are still retained.
+        cursor.skipped += m_watermark.arrivals - cursor.arrivals;
+        cursor.arrivals = m_watermark.arrivals;
+        cursor.faults = m_watermark.faults;
+        cursor.signal_samples = m_watermark.signal_samples;
+    }
+    if (cursor.arrivals >= m_arrivals.end()) return false;
+    int32_t channel = m_arrivals[cursor.arrivals++];
+    if (channel == kFaultChannel) {
+        uint64_t sequence = cursor.faults++;
+        const FaultEvent& event = m_faults[sequence];
+        sample = {event.timestamp_ms, event.value, -1, event.parameter, &getFaultName(sequence)};
+        return true;
+    }
+    size_t signal = static_cast<size_t>(channel);
+    if (cursor.signal_samples.size() < m_columns.size()) cursor.signal_samples.resize(m_columns.size(), 0);
+    uint64_t sequence = cursor.signal_samples[signal]++;
+    sample = {m_columns[signal].timestamps[sequence], m_columns[signal].values[sequence], channel,
+              m_internal_id_to_parameter[signal], nullptr};
+    return true;
+}
+
+// Releases from the front of each ring only, so a sample that arrived out of time order can hold
+// later-ingested but older samples behind it until it expires itself.
+void SignalIngestor::compact(const IngestCursor& consumed) {
+    bool past_end = consumed.arrivals > m_arrivals.end() || consumed.faults > m_faults.end() ||
+                    consumed.signal_samples.size() > m_columns.size();
+    for (size_t signal = 0; signal < consumed.signal_samples.size() && !past_end; ++signal) {
+        past_end = consumed.signal_samples[signal] > m_columns[signal].timestamps.end();
+    }
+    if (past_end) {
+        throw std::out_of_range("Compaction watermark is past the end of the ingested stream.");
+    }
+    if (consumed.arrivals < m_watermark.arrivals) return;
+
+    auto expired = [this](uint64_t timestamp_ms) {
+        return m_latest_timestamp_ms > m_horizon_ms && timestamp_ms < m_latest_timestamp_ms - m_horizon_ms;
+    };
+
+    for (size_t signal = 0; signal < m_columns.size(); ++signal) {
+        SignalColumns& columns = m_columns[signal];
+        uint64_t read = signal < consumed.signal_samples.size() ? consumed.signal_samples[signal] : 0;
+        // Never past the watermark, and always keep the latest value of the signal.
+        uint64_t limit = std::min(read, columns.timestamps.end() - (columns.timestamps.empty() ? 0 : 1));
+        uint64_t first = columns.timestamps.begin();
+        while (first < limit && expired(columns.timestamps[first])) ++first;
+        columns.timestamps.release(first);
+        columns.values.release(first);
+    }
+
+    uint64_t first_fault = m_faults.begin();
+    while (first_fault < std::min(consumed.faults, m_faults.end()) && expired(m_faults[first_fault].timestamp_ms)) {
+        ++first_fault;
+    }
+    m_faults.release(first_fault);
+    m_fault_names.release(first_fault);
+
+    // The journal only serves replay, so consumed entries go right away.
+    m_arrivals.release(consumed.arrivals);
+    m_watermark.arrivals = consumed.arrivals;
+    m_watermark.faults = consumed.faults;
+    m_watermark.signal_samples.assign(consumed.signal_samples.begin(), consumed.signal_samples.end());
+}
+
+size_t SignalIngestor::getRetainedBytes(int internalId) const {
+    const SignalColumns& signal = columns(internalId);
+    return signal.timestamps.capacity() * sizeof(uint64_t) + signal.values.capacity() * sizeof(double);
 }
 
-// Retrieves the complete history of ingested samples.
-const std::vector<DataSample>& SignalIngestor::getSamples() const {
-    return m_samples;
-}
\ No newline at end of file
+size_t SignalIngestor::getRetainedBytes() const {
+    size_t bytes = m_faults.capacity() * sizeof(FaultEvent) + m_fault_names.capacity() * sizeof(std::string) +
+                   m_arrivals.capacity() * sizeof(int32_t);
+    for (size_t signal = 0; signal < m_columns.size(); ++signal) {
+        bytes += getRetainedBytes(static_cast<int>(signal));
+    }
+    return bytes;
+}
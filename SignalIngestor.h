@@ -9,6 +9,17 @@
  * @requirement REQ-IN-01: The application shall define a DataSample structure.
  * @requirement REQ-IN-02: The class shall implement a Signal Normalization buffer.
  * @requirement REQ-IN-03: The class shall map parameterID strings to unique internal integer IDs for O(1) lookup speed.
+ *
+ * Samples are stored by column rather than as DataSample records: each internal signal ID has a
+ * ring buffer of timestamps and one of values, samples of unknown parameters (fault injections)
+ * go to a compact fault event log, and an arrival journal records which of these each sample went
+ * to, so readers can replay the stream in ingestion order (next()). No string is kept per sample.
+ *
+ * Retention: nothing is dropped until compact() is called with a consumer's cursor (its watermark).
+ * From then on a sample is kept while it is unconsumed, is the latest of its signal, or lies within
+ * the retention horizon of the newest timestamp ingested. Built from a model, the horizon is the compiled
+ * graph's largest time_max_ms, beyond which no propagation check looks back, so memory stays bounded on
+ * endless streams.
  */
 
 #include <cstdint>
@@ -17,6 +28,9 @@
 #include <unordered_map>
 
 #include "json.hpp" // For using nlohmann::json
+#include "SymbolTable.h"
+#include "rTFPGModel.h"
+#include "RingBuffer.h"
 
 /**
  * @brief REQ-IN-01: Defines the structure for a single data point from a test stream. 
@@ -33,13 +47,46 @@ struct DataSample {
     bool is_failure_mode;
 };
 
+/// @brief A sample whose parameter is not a model signal, e.g. a fault injection.
+struct FaultEvent {
+    uint64_t timestamp_ms;
+    double value;
+    Symbol parameter; ///< The parameter ID if interned in SymbolTable::shared(), else kNoSymbol (see SignalIngestor::getFaultName())
+};
+
+/// @brief One ingested sample as read back by SignalIngestor::next().
+struct IngestedSample {
+    uint64_t timestamp_ms;
+    double value;
+    int signal_id;    ///< Internal signal ID, or -1 for a FaultEvent
+    Symbol parameter; ///< The parameter ID if interned in SymbolTable::shared(), else kNoSymbol (fault events only)
+    const std::string* fault_name; ///< A FaultEvent's parameter ID, valid until the next ingest() or compact(); null for signals
+};
+
+/// @brief A reader's position in the ingested stream, advanced by SignalIngestor::next().
+struct IngestCursor {
+    uint64_t arrivals = 0;               ///< Samples consumed
+    uint64_t faults = 0;                 ///< Fault events consumed
+    std::vector<uint64_t> signal_samples; ///< Samples consumed, by internal signal ID
+    uint64_t skipped = 0;                ///< Samples compacted away before this reader reached them
+};
+
 class SignalIngestor {
 public:
     /**
      * @brief Constructs a SignalIngestor.
      * @param fault_model The parsed JSON fault model, used to pre-populate signal ID mappings.
+     * @param horizon_ms The retention horizon. The raw JSON does not give the delays the model compiles
+     *        to (template instances add edges), so pass CompiledGraph::maxPropagationDelay() of the
+     *        loaded model; the default keeps every sample.
      */
-    explicit SignalIngestor(const nlohmann::json& fault_model);
+    explicit SignalIngestor(const nlohmann::json& fault_model, uint64_t horizon_ms = UINT64_MAX);
+    /**
+     * @brief Constructs a SignalIngestor from an already loaded model (e.g. a compiled snapshot).
+     *        Signals are registered in the same order as by the JSON constructor, and the retention
+     *        horizon is the compiled graph's maxPropagationDelay().
+     */
+    explicit SignalIngestor(const rTFPGModel& model);
 
     // REQ-IN-03: Map parameterID strings to unique internal integer IDs for O(1) lookup.
     /**
@@ -48,6 +95,8 @@ public:
      * @return The internal integer ID, or -1 if not found.
      */
     int getInternalId(const std::string& parameterID) const;
+    /// @brief As above, for an interned parameter ID (e.g. IngestedSample::parameter). No hashing.
+    int getInternalId(Symbol parameter) const;
     /**
      * @brief Gets the string parameter ID for a given internal integer ID.
      * @param internalId The internal integer ID.
@@ -58,25 +107,100 @@ public:
 
     // REQ-IN-02: Ingests a sample into the normalization buffer.
     /**
-     * @brief Adds a new data sample to the internal buffer.
-     * @param sample The DataSample to add.
+     * @brief Appends a sample to its signal's columns, or to the fault event log if its parameterID
+     *        is not a registered signal. The parameterID is never interned here: a fault event whose ID
+     *        is not in SymbolTable::shared() keeps its own copy, which compact() drops with the event.
+     * @param sample The DataSample to add. Only its timestamp, value and parameter ID are kept.
      */
     void ingest(const DataSample& sample);
     /**
-     * @brief Retrieves the complete history of ingested samples.
-     * @return A constant reference to the vector of samples.
+     * @brief Fast path for a reading of a registered signal, resolved once up front with getInternalId().
+     *        Equivalent to ingesting a DataSample with that signal's parameter ID, without hashing or
+     *        constructing a string.
+     * @throws std::out_of_range if the internalId is invalid.
+     */
+    void ingest(int internalId, uint64_t timestamp_ms, double value);
+    /// @brief Batch form of ingest(const DataSample&): appends count samples in order.
+    void ingest(const DataSample* samples, size_t count);
+    /**
+     * @brief Batch form of the fast path: appends count readings of one signal, given as columns.
+     * @throws std::out_of_range if the internalId is invalid; nothing is appended then.
+     */
+    void ingest(int internalId, const uint64_t* timestamps_ms, const double* values, size_t count);
+
+    /**
+     * @brief Reads the sample after cursor, in ingestion order, and advances the cursor past it.
+     *        A cursor behind the last compact() watermark first jumps to it, since the samples in
+     *        between may have been dropped; their number is added to cursor.skipped.
+     * @return false if the cursor is at the end of the stream; sample is then unchanged.
+     */
+    bool next(IngestCursor& cursor, IngestedSample& sample) const;
+
+    /// @brief Number of samples ingested so far.
+    uint64_t getArrivalCount() const { return m_arrivals.end(); }
+    /// @brief Number of registered signals; internal IDs are 0 .. getSignalCount() - 1.
+    size_t getSignalCount() const { return m_internal_id_to_parameter.size(); }
+
+    /**
+     * @brief Timestamps and values of one signal, by per-signal sequence number (the n-th sample of
+     *        the signal is element n of both). Contiguous runs are available through RingBuffer::run().
+     * @throws std::out_of_range if the internalId is invalid.
+     */
+    const RingBuffer<uint64_t>& getTimestamps(int internalId) const;
+    const RingBuffer<double>& getValues(int internalId) const;
+    /// @brief Samples of parameters that are not registered signals, in ingestion order.
+    const RingBuffer<FaultEvent>& getFaultEvents() const { return m_faults; }
+    /// @brief Parameter ID of the fault event with this sequence number, which must be retained.
+    const std::string& getFaultName(uint64_t sequence) const;
+
+    /// @brief How far (ms) behind the newest ingested timestamp consumed samples are kept by compact().
+    uint64_t getRetentionHorizon() const { return m_horizon_ms; }
+    void setRetentionHorizon(uint64_t horizon_ms) { m_horizon_ms = horizon_ms; }
+
+    /**
+     * @brief Drops the samples and fault events that the retention policy above no longer needs.
+     * @param consumed The consumer watermark: nothing at or after this cursor is dropped. With several
+     *        readers, pass the one furthest behind; a reader left behind skips ahead in next().
+     *        A watermark behind the last one drops nothing.
+     * @throws std::out_of_range if the watermark is past the end of the stream; nothing is dropped then.
      */
-    const std::vector<DataSample>& getSamples() const;
+    void compact(const IngestCursor& consumed);
+
+    /// @brief Samples of one signal currently held (ingested and not yet dropped).
+    size_t getRetainedSampleCount(int internalId) const { return columns(internalId).timestamps.size(); }
+    /// @brief Bytes of sample storage allocated for one signal.
+    size_t getRetainedBytes(int internalId) const;
+    /// @brief Bytes allocated for all signals, the fault event log (excluding long fault names) and the arrival journal.
+    size_t getRetainedBytes() const;
 
 private:
-    /// Map from string parameter IDs to internal integer IDs for fast lookups.
-    std::unordered_map<std::string, int> m_parameter_to_internal_id; 
-    /// Vector to map internal integer IDs back to string parameter IDs.
-    std::vector<std::string> m_internal_id_to_parameter; 
+    /// Interned parameter ID -> internal integer ID (or -1), for array lookups.
+    std::vector<int> m_parameter_to_internal_id; 
+    /// Vector to map internal integer IDs back to interned parameter IDs.
+    std::vector<Symbol> m_internal_id_to_parameter; 
+    void registerSignal(const std::string& source_name);
+
     /// The next available internal ID to be assigned.
     int m_next_internal_id = 0; 
-    /// The buffer storing all ingested data samples in order of arrival.
-    std::vector<DataSample> m_samples; 
+    // Columnar sample storage of one signal; both rings share the per-signal sequence numbers.
+    struct SignalColumns {
+        RingBuffer<uint64_t> timestamps;
+        RingBuffer<double> values;
+    };
+    /// Internal signal ID -> its samples.
+    std::vector<SignalColumns> m_columns;
+    RingBuffer<FaultEvent> m_faults;
+    /// Parameter IDs of fault events that are not interned, by fault sequence number; empty for the others.
+    RingBuffer<std::string> m_fault_names;
+    /// Arrival journal: internal signal ID of each sample in ingestion order, or kFaultChannel.
+    RingBuffer<int32_t> m_arrivals;
+    static constexpr int32_t kFaultChannel = -1;
+    uint64_t m_horizon_ms = UINT64_MAX;  // Unbounded unless derived from a model or set
+    uint64_t m_latest_timestamp_ms = 0;  // Newest timestamp ingested
+    IngestCursor m_watermark;            // Furthest compact() watermark; the journal starts there
+
+    const SignalColumns& columns(int internalId) const;
+    void appendSignalSample(size_t internalId, uint64_t timestamp_ms, double value);
 };
 
 #endif // SIGNAL_INGESTOR_H
\ No newline at end of file
@@ -0,0 +1,113 @@
+#include "SymbolTable.h"
+#include <functional>
+#include <stdexcept>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace {
+constexpr size_t kInitialIndexCapacity = 1024; // Power of two
+}
+
+SymbolTable::SymbolTable() {
+    m_indexes.push_back(std::make_unique<Index>(kInitialIndexCapacity));
+    m_index.store(m_indexes.back().get(), std::memory_order_release);
+}
+
+SymbolTable::~SymbolTable() {
+    for (std::string* chunk : m_chunks) delete[] chunk;
+}
+
+SymbolTable& SymbolTable::shared() {
+    static SymbolTable table;
+    return table;
+}
+
+uint64_t SymbolTable::hash(const std::string& name) {
+    return static_cast<uint64_t>(std::hash<std::string>{}(name));
+}
+
+void SymbolTable::locate(Symbol symbol, size_t& chunk, size_t& offset) {
+    // chunk = floor(log2(symbol / kFirstChunkSize + 1))
+    uint64_t v = (static_cast<uint64_t>(symbol) >> kFirstChunkBits) + 1;
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanReverse64(&index, v);
+    chunk = static_cast<size_t>(index);
+#else
+    chunk = static_cast<size_t>(63 - __builtin_clzll(v));
+#endif
+    offset = static_cast<size_t>(symbol - (static_cast<uint64_t>(kFirstChunkSize) << chunk) + kFirstChunkSize);
+}
+
+const std::string& SymbolTable::at(Symbol symbol) const {
+    size_t chunk, offset;
+    locate(symbol, chunk, offset);
+    return m_chunks[chunk][offset];
+}
+
+// Linear probing; the index is kept at most half full, so every probe sequence reaches an empty slot.
+Symbol SymbolTable::find(const std::string& name, uint64_t hash) const {
+    const Index* index = m_index.load(std::memory_order_acquire);
+    const uint32_t tag = static_cast<uint32_t>(hash >> 32);
+    for (size_t i = static_cast<size_t>(hash) & index->mask;; i = (i + 1) & index->mask) {
+        uint64_t slot = index->slots[i].load(std::memory_order_acquire);
+        if (slot == 0) return kNoSymbol;
+        if (static_cast<uint32_t>(slot >> 32) == tag) {
+            Symbol symbol = static_cast<Symbol>(slot) - 1;
+            if (at(symbol) == name) return symbol;
+        }
+    }
+}
+
+void SymbolTable::insert(const Index& index, uint64_t hash, Symbol symbol) {
+    size_t i = static_cast<size_t>(hash) & index.mask;
+    while (index.slots[i].load(std::memory_order_relaxed) != 0) i = (i + 1) & index.mask;
+    index.slots[i].store(((hash >> 32) << 32) | (static_cast<uint64_t>(symbol) + 1), std::memory_order_release);
+}
+
+Symbol SymbolTable::find(const std::string& name) const {
+    return find(name, hash(name));
+}
+
+Symbol SymbolTable::intern(const std::string& name) {
+    const uint64_t h = hash(name);
+    Symbol found = find(name, h);
+    if (found != kNoSymbol) return found;
+
+    std::lock_guard<std::mutex> lock(m_write_mutex);
+    found = find(name, h); // Another thread may have interned it since
+    if (found != kNoSymbol) return found;
+
+    const size_t count = m_size.load(std::memory_order_relaxed);
+    if (count >= kNoSymbol) {
+        throw std::length_error("Symbol table is full.");
+    }
+    const Symbol symbol = static_cast<Symbol>(count);
+    size_t chunk, offset;
+    locate(symbol, chunk, offset);
+    if (!m_chunks[chunk]) m_chunks[chunk] = new std::string[kFirstChunkSize << chunk];
+    m_chunks[chunk][offset] = name;
+
+    // Keep the index at most half full. Readers that loaded the outgrown index finish on it; it lacks
+    // only symbols interned after they started.
+    const Index* index = m_indexes.back().get();
+    if ((count + 1) * 2 > index->mask + 1) {
+        auto grown = std::make_unique<Index>((index->mask + 1) * 2);
+        for (Symbol s = 0; s < symbol; ++s) insert(*grown, hash(at(s)), s);
+        index = grown.get();
+        m_indexes.push_back(std::move(grown));
+        m_index.store(index, std::memory_order_release);
+    }
+    insert(*index, h, symbol);
+    m_size.store(count + 1, std::memory_order_release);
+    return symbol;
+}
+
+const std::string& SymbolTable::name(Symbol symbol) const {
+    if (symbol >= size()) {
+        throw std::out_of_range("Unknown symbol.");
+    }
+    return at(symbol);
+}
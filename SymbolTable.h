@@ -0,0 +1,87 @@
+#ifndef SYMBOL_TABLE_H
+#define SYMBOL_TABLE_H
+
+/**
+ * @class SymbolTable
+ * @brief Process-wide interning of identifier strings (node IDs, signal IDs, parameter IDs).
+ *
+ * Each distinct string is assigned a stable 32-bit Symbol the first time it is interned and is
+ * stored exactly once. rTFPGModel and SignalIngestor index their lookup tables by Symbol, so a
+ * string is hashed once at the API boundary and every later lookup is an array access.
+ * Symbols are dense (0, 1, 2, ...) and are never released. All methods are thread-safe.
+ *
+ * find(), name() and size() never lock: names are stored in append-only chunks that never move, and
+ * the hash index is an open-addressing table whose slots are published with atomic stores. Only
+ * intern() of a string that is not in the table yet takes the writer mutex.
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+using Symbol = uint32_t;
+
+/// Returned by SymbolTable::find() for strings that were never interned.
+constexpr Symbol kNoSymbol = UINT32_MAX;
+
+class SymbolTable {
+public:
+    SymbolTable();
+    ~SymbolTable();
+
+    SymbolTable(const SymbolTable&) = delete;
+    SymbolTable& operator=(const SymbolTable&) = delete;
+
+    /// @brief The table shared by all models and ingestors in the process.
+    static SymbolTable& shared();
+
+    /// @brief Returns the symbol of name, assigning the next free symbol if it is new.
+    Symbol intern(const std::string& name);
+
+    /// @brief Returns the symbol of name, or kNoSymbol if it was never interned. Never allocates or locks.
+    Symbol find(const std::string& name) const;
+
+    /**
+     * @brief Materializes a symbol as its string. Never locks.
+     * @return A reference that stays valid for the lifetime of the table.
+     * @throws std::out_of_range if the symbol was not issued by this table.
+     */
+    const std::string& name(Symbol symbol) const;
+
+    /// @brief Number of symbols issued so far; every symbol is below this value.
+    size_t size() const { return m_size.load(std::memory_order_acquire); }
+
+private:
+    // Chunk c holds kFirstChunkSize << c names and starts at symbol kFirstChunkSize * (2^c - 1), so
+    // kMaxChunks chunks cover every symbol below kNoSymbol.
+    static constexpr size_t kFirstChunkBits = 8;
+    static constexpr size_t kFirstChunkSize = size_t(1) << kFirstChunkBits;
+    static constexpr size_t kMaxChunks = 32 - kFirstChunkBits + 1;
+
+    // Slot of the hash index: (hash high bits << 32) | (symbol + 1), or 0 if empty.
+    struct Index {
+        explicit Index(size_t capacity) : mask(capacity - 1), slots(new std::atomic<uint64_t>[capacity]) {
+            for (size_t i = 0; i < capacity; ++i) slots[i].store(0, std::memory_order_relaxed);
+        }
+        size_t mask;
+        std::unique_ptr<std::atomic<uint64_t>[]> slots;
+    };
+
+    std::mutex m_write_mutex;                            // Serializes intern() of new names
+    std::atomic<size_t> m_size{0};                       // Published after the name and its slot
+    std::string* m_chunks[kMaxChunks] = {};              // Written before any symbol in them is published
+    std::atomic<const Index*> m_index{nullptr};
+    std::vector<std::unique_ptr<Index>> m_indexes;       // Current and outgrown indexes; readers may still hold the latter
+
+    static uint64_t hash(const std::string& name);
+    static void locate(Symbol symbol, size_t& chunk, size_t& offset);
+    const std::string& at(Symbol symbol) const;
+    Symbol find(const std::string& name, uint64_t hash) const;
+    static void insert(const Index& index, uint64_t hash, Symbol symbol);
+};
+
+#endif // SYMBOL_TABLE_H
@@ -0,0 +1,149 @@
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+/**
+ * @class WorkerPool
+ * @brief Persistent helper threads that run body(0) ... body(count - 1) together with the caller.
+ *
+ * Used to reason about independent graph partitions concurrently. The helpers are started by the
+ * first parallel loop and then sleep between loops, so a diagnosis per sample pays for waking them,
+ * not for creating threads. Even that costs more than a small loop, so parallelFor() runs inline when
+ * the caller's work estimate is below kMinParallelWork, when there is one worker, or fewer than two
+ * items.
+ *
+ * Indices are handed out from a shared counter, so the order in which they run is unspecified;
+ * callers write each index's result to its own slot and merge afterwards in index order. The first
+ * exception thrown by body is rethrown on the calling thread once all workers have stopped.
+ * parallelFor() must not be called concurrently, or from within body, on the same pool.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+class WorkerPool {
+public:
+    /// Below this many node visits (the callers' work unit) a loop runs inline on the caller.
+    static constexpr size_t kMinParallelWork = 4096;
+
+    /// @param worker_count Threads to use, the calling thread included. 1 stays single-threaded.
+    explicit WorkerPool(size_t worker_count = 1) : m_worker_count(std::max<size_t>(worker_count, 1)) {}
+    ~WorkerPool() { stopHelpers(); }
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    size_t workerCount() const { return m_worker_count; }
+
+    /// @brief Changes the number of workers. Running helpers are stopped; new ones start on demand.
+    void setWorkerCount(size_t worker_count) {
+        stopHelpers();
+        m_worker_count = std::max<size_t>(worker_count, 1);
+    }
+
+    /**
+     * @brief Runs body(i) for every i in [0, count).
+     * @param work The caller's estimate of the loop's total cost, in node visits.
+     */
+    template <class Body>
+    void parallelFor(size_t count, size_t work, Body&& body) {
+        if (m_worker_count <= 1 || count < 2 || work < kMinParallelWork || !startHelpers()) {
+            for (size_t i = 0; i < count; ++i) body(i);
+            return;
+        }
+
+        using Fn = std::remove_reference_t<Body>;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_body = const_cast<void*>(static_cast<const void*>(std::addressof(body)));
+            m_invoke = [](void* b, size_t i) { (*static_cast<Fn*>(b))(i); };
+            m_count = count;
+            m_next.store(0);
+            m_failure = nullptr;
+            ++m_generation;
+        }
+        m_wake.notify_all();
+        runItems();
+
+        // Every index is claimed, so no helper joins from here on; wait for those still running.
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_done.wait(lock, [this] { return m_active == 0; });
+        if (m_failure) std::rethrow_exception(m_failure);
+    }
+
+private:
+    size_t m_worker_count;
+    std::vector<std::thread> m_helpers;
+    std::mutex m_mutex;
+    std::condition_variable m_wake; // A new loop, or stop
+    std::condition_variable m_done; // m_active reached 0
+    bool m_stopping = false;
+    uint64_t m_generation = 0;      // Loops started
+    size_t m_active = 0;            // Helpers inside the current loop
+
+    // The current loop, written under m_mutex before m_generation is bumped.
+    void* m_body = nullptr;
+    void (*m_invoke)(void*, size_t) = nullptr;
+    size_t m_count = 0;
+    std::atomic<size_t> m_next{0};
+    std::exception_ptr m_failure;
+
+    // Starts the missing helpers. False if none could be created; then the loop runs inline.
+    bool startHelpers() {
+        try {
+            while (m_helpers.size() + 1 < m_worker_count) m_helpers.emplace_back([this] { helperMain(); });
+        } catch (const std::system_error&) {
+            // Out of threads: the ones already started and the caller share the work.
+        }
+        return !m_helpers.empty();
+    }
+
+    void stopHelpers() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+        }
+        m_wake.notify_all();
+        for (std::thread& helper : m_helpers) helper.join();
+        m_helpers.clear();
+        m_stopping = false;
+    }
+
+    void helperMain() {
+        uint64_t seen = 0;
+        std::unique_lock<std::mutex> lock(m_mutex);
+        for (;;) {
+            m_wake.wait(lock, [&] { return m_stopping || m_generation != seen; });
+            if (m_stopping) return;
+            seen = m_generation;
+            if (m_next.load() >= m_count) continue; // Woke after the loop was finished
+            ++m_active;
+            lock.unlock();
+            runItems();
+            lock.lock();
+            if (--m_active == 0) m_done.notify_one();
+        }
+    }
+
+    void runItems() {
+        for (size_t i = m_next.fetch_add(1); i < m_count; i = m_next.fetch_add(1)) {
+            try {
+                m_invoke(m_body, i);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (!m_failure) m_failure = std::current_exception();
+                m_next.store(m_count); // Stop handing out work
+            }
+        }
+    }
+};
+
+#endif // WORKER_POOL_H
@@ -0,0 +1,127 @@
+// Heap allocations per diagnosis call.
+//
+// Replaces the global operator new with a counting one and replays a scenario, calling
+// findActiveHypotheses() and findTopHypotheses() after every sample. The scenario grows the engine's
+// buffers; it is followed by a steady stretch that repeats each signal's last value, where no call
+// activates a node and so no call may allocate. Exits with 1 if one did.
+//
+// Build from the repository root:
+//   g++ -std=c++17 -O2 -pthread -I. -o alloc_count bench/alloc_count.cpp $(ls *.cpp | grep -v '^main.cpp$')
+// Usage: alloc_count [fault_model.json] [test_data.json] [steady_samples]
+
+#include "DataStreamReader.h"
+#include "LogicEngine.h"
+#include "ModelLoader.h"
+#include "SignalIngestor.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <new>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+static size_t g_allocations = 0;
+
+void* operator new(std::size_t size) {
+    ++g_allocations;
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+namespace {
+
+struct CallStats {
+    size_t calls = 0;
+    size_t allocations = 0;
+};
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::string modelPath = argc > 1 ? argv[1] : "FaultModels/obogs_fault_model.json";
+    std::string testDataPath = argc > 2 ? argv[2] : "FaultScenarios/obogs_failure_scenario.json";
+    size_t steadySamples = argc > 3 ? std::stoul(argv[3]) : 10000;
+
+    std::optional<rTFPGModel> model;
+    try {
+        std::ifstream file(modelPath);
+        if (!file.is_open()) throw std::runtime_error("Could not open model file: " + modelPath);
+        model.emplace(ModelLoader::parse(file));
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    std::ifstream testDataFile(testDataPath);
+    if (!testDataFile.is_open()) {
+        std::cerr << "Error: Could not open test data file: " << testDataPath << std::endl;
+        return 1;
+    }
+
+    SignalIngestor ingestor(*model);
+    LogicEngine engine(*model, ingestor);
+    NullEventSink silent;
+    engine.setEventSink(silent);
+
+    CallStats activating, quiet;
+    // Diagnoses after one sample and files the allocations under whether a node was activated.
+    auto diagnose = [&]() {
+        const uint64_t activations = engine.getCounters().activations;
+        const size_t before = g_allocations;
+        engine.findActiveHypotheses();
+        engine.findTopHypotheses(3, 0.1);
+        CallStats& stats = engine.getCounters().activations == activations ? quiet : activating;
+        stats.calls++;
+        stats.allocations += g_allocations - before;
+        ingestor.compact(engine.getCursor());
+    };
+
+    uint64_t lastTimestamp = 0;
+    std::map<int, double> lastValues; // Internal signal ID -> last value
+    try {
+        DataStreamReader::read(testDataFile, [](const nlohmann::json&) {}, [&](const nlohmann::json& event) {
+            if (event.contains("comment")) return;
+            DataSample sample;
+            sample.timestamp_ms = event["timestamp_ms"];
+            sample.parameterID = event["parameter_id"];
+            sample.is_failure_mode = event.value("is_failure_mode", false);
+            sample.value = event["value"].is_boolean() ? (event["value"] ? 1.0 : 0.0) : event["value"].get<double>();
+            ingestor.ingest(sample);
+            diagnose();
+            lastTimestamp = sample.timestamp_ms;
+            int signal = ingestor.getInternalId(sample.parameterID);
+            if (signal >= 0) lastValues[signal] = sample.value;
+        });
+    } catch (const std::exception& e) {
+        std::cerr << "Test Data Error: " << e.what() << std::endl;
+        return 1;
+    }
+    const CallStats scenarioActivating = activating;
+    const CallStats scenarioQuiet = quiet;
+
+    // Steady state: the signals keep reporting what they last reported.
+    std::vector<std::pair<int, double>> steady(lastValues.begin(), lastValues.end());
+    for (size_t i = 0; i < steadySamples && !steady.empty(); ++i) {
+        ingestor.ingest(steady[i % steady.size()].first, lastTimestamp += 10, steady[i % steady.size()].second);
+        diagnose();
+    }
+    const size_t steadyCalls = quiet.calls - scenarioQuiet.calls + activating.calls - scenarioActivating.calls;
+    const size_t steadyAllocations = quiet.allocations - scenarioQuiet.allocations + activating.allocations - scenarioActivating.allocations;
+
+    std::cout << "Scenario: " << activating.calls << " activating calls (" << activating.allocations
+              << " allocations), " << scenarioQuiet.calls << " other calls (" << scenarioQuiet.allocations
+              << " allocations)" << std::endl;
+    std::cout << "Steady state: " << steadyCalls << " calls (" << steadyAllocations << " allocations)" << std::endl;
+    if (steadyAllocations != 0) {
+        std::cout << "FAIL: steady-state diagnosis calls allocated." << std::endl;
+        return 1;
+    }
+    std::cout << "OK: steady-state diagnosis calls do not allocate." << std::endl;
+    return 0;
+}
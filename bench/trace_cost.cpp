@@ -0,0 +1,77 @@
+// Per-sample cost of the diagnosis loop as the trace grows.
+//
+// Replays a generated stream through the same ingest / findActiveHypotheses() / compact() loop as
+// main.cpp and prints the mean cost per sample for each tenth of the trace. The engine only
+// evaluates samples ingested since its last call, so the cost should stay flat however long the
+// trace gets; a rescan of the whole history would grow linearly from block to block.
+//
+// Build from the repository root:
+//   g++ -std=c++17 -O2 -pthread -I. -o trace_cost bench/trace_cost.cpp $(ls *.cpp | grep -v '^main.cpp$')
+// Usage: trace_cost [fault_model.json] [samples]
+
+#include "LogicEngine.h"
+#include "ModelLoader.h"
+#include "SignalIngestor.h"
+
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+int main(int argc, char* argv[]) {
+    std::string modelPath = argc > 1 ? argv[1] : "FaultModels/obogs_fault_model.json";
+    size_t sampleCount = argc > 2 ? std::stoul(argv[2]) : 200000;
+    const size_t blocks = 10;
+
+    std::optional<rTFPGModel> model;
+    try {
+        std::ifstream file(modelPath);
+        if (!file.is_open()) throw std::runtime_error("Could not open model file: " + modelPath);
+        model.emplace(ModelLoader::parse(file));
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    const auto& signals = model->getSignals();
+    if (signals.empty() || sampleCount < blocks) {
+        std::cerr << "Error: the model needs signals and the trace at least " << blocks << " samples." << std::endl;
+        return 1;
+    }
+
+    SignalIngestor ingestor(*model);
+    LogicEngine engine(*model, ingestor);
+    NullEventSink silent;
+    engine.setEventSink(silent);
+
+    // Signals take turns, 10 ms apart, with values spread over their range so predicates flip.
+    std::mt19937_64 rng(1);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    std::vector<int> ids;
+    for (const auto& signal : signals) ids.push_back(ingestor.getInternalId(signal.source_name));
+
+    std::cout << "Model: " << modelPath << " (" << model->getNodes().size() << " nodes), "
+              << sampleCount << " samples" << std::endl;
+    const size_t blockSize = sampleCount / blocks;
+    size_t checksum = 0;
+    for (size_t block = 0; block < blocks; ++block) {
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = block * blockSize; i < (block + 1) * blockSize; ++i) {
+            const Signal& signal = signals[i % signals.size()];
+            double value = signal.range_min + (signal.range_max - signal.range_min) * unit(rng);
+            ingestor.ingest(ids[i % ids.size()], static_cast<uint64_t>(i) * 10, value);
+            checksum += engine.findActiveHypotheses().size();
+            ingestor.compact(engine.getCursor());
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "  samples " << std::setw(8) << block * blockSize << " - " << std::setw(8) << (block + 1) * blockSize
+                  << ": " << std::fixed << std::setprecision(3) << seconds * 1e6 / blockSize << " us/sample, "
+                  << ingestor.getRetainedBytes() << " bytes retained" << std::endl;
+    }
+    std::cout << "Hypotheses reported: " << checksum << std::endl;
+    return 0;
+}
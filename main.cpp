@@ -8,6 +8,8 @@
 #include <cmath>
 #include <map>
 #include <set>
+#include <optional>
+#include <sstream>
 
 // This code assumes you have the nlohmann/json library available.
 // If using a package manager like vcpkg: vcpkg install nlohmann-json
@@ -17,14 +19,113 @@
 #include "LogicEngine.h"
 #include "SignalIngestor.h"
 #include "PrognosisManager.h"
+#include "ModelSnapshot.h"
+#include "ModelLoader.h"
+#include "DataStreamReader.h"
+#include "ReorderBuffer.h"
 
 
 using json = nlohmann::json;
 
+// Reads a whole file; returns false if it cannot be opened.
+static bool readFile(const std::string& path, std::string& contents) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) return false;
+    std::ostringstream buffer;
+    buffer << file.rdbuf();
+    contents = buffer.str();
+    return true;
+}
+
+static bool isSnapshotPath(const std::string& path) {
+    const std::string extension = ".rtfpgc";
+    return path.size() > extension.size() &&
+           path.compare(path.size() - extension.size(), extension.size(), extension) == 0;
+}
+
+// Converts a JSON fault model into a compiled snapshot: --compile <fault_model.json> [snapshot.rtfpgc]
+static int compileModel(int argc, char* argv[]) {
+    if (argc < 3 || argc > 4) {
+        std::cerr << "Usage: " << argv[0] << " --compile <fault_model.json> [snapshot.rtfpgc]" << std::endl;
+        return 1;
+    }
+    std::string modelPath = argv[2];
+    std::string snapshotPath = argc == 4 ? argv[3] : ModelSnapshot::cachePathFor(modelPath);
+
+    std::string modelText;
+    if (!readFile(modelPath, modelText)) {
+        std::cerr << "Error: Could not open model file: " << modelPath << std::endl;
+        return 1;
+    }
+    try {
+        rTFPGModel model = ModelLoader::parse(modelText);
+        ModelSnapshot::write(model, ModelSnapshot::hash(modelText.data(), modelText.size()), snapshotPath);
+        std::cout << "Compiled " << modelPath << " (" << model.getNodes().size() << " nodes, "
+                  << model.getEdges().size() << " edges) to " << snapshotPath << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
 int main(int argc, char* argv[]) {
 
+    if (argc >= 2 && std::string(argv[1]) == "--compile") {
+        return compileModel(argc, argv);
+    }
+
+    // Optional leading options, each taking an integer:
+    //   --threads N          worker threads for reasoning about independent graph partitions
+    //   --checkpoint-ms N    batch replay: evaluate the samples of each N ms window in one pass, then diagnose once
+    //   --max-lateness-ms N  reorder samples arriving up to N ms late (0 allowed); later ones are dropped
+    // and one flag:
+    //   --stats              print engine, ingestor and reorder counters to stderr at the end of the run
+    size_t worker_threads = 1;
+    uint64_t checkpoint_ms = 0; // 0: diagnose after every sample
+    std::optional<uint64_t> max_lateness_ms; // Unset: samples are taken in file order
+    bool print_stats = false;
+    while (argc >= 2) {
+        std::string option = argv[1];
+        if (option == "--stats") {
+            print_stats = true;
+            argv[1] = argv[0];
+            argv += 1;
+            argc -= 1;
+            continue;
+        }
+        if (argc < 3 || (option != "--threads" && option != "--checkpoint-ms" && option != "--max-lateness-ms")) {
+            break;
+        }
+        const bool allow_zero = option == "--max-lateness-ms";
+        unsigned long long value = 0;
+        try {
+            size_t pos;
+            value = std::stoull(argv[2], &pos);
+            if (pos != std::string(argv[2]).length() || argv[2][0] == '-' || (value == 0 && !allow_zero)) {
+                throw std::invalid_argument("Not a positive integer");
+            }
+        } catch (...) {
+            std::cerr << "Error: Invalid value '" << argv[2] << "' for " << option << ". Must be a "
+                      << (allow_zero ? "non-negative" : "positive") << " integer." << std::endl;
+            return 1;
+        }
+        if (option == "--threads") {
+            worker_threads = static_cast<size_t>(value);
+        } else if (option == "--checkpoint-ms") {
+            checkpoint_ms = value;
+        } else {
+            max_lateness_ms = value;
+        }
+        // Drop the option so the positional arguments keep their indices.
+        argv[2] = argv[0];
+        argv += 2;
+        argc -= 2;
+    }
+
     if (argc < 3 || argc > 5) {
-        std::cerr << "Usage: " << argv[0] << " <fault_model.json> <test_data.json> [criticality_threshold] [output_log_file]" << std::endl;
+        std::cerr << "Usage: " << argv[0] << " [--threads N] [--checkpoint-ms N] [--max-lateness-ms N] [--stats] <fault_model.json|fault_model.rtfpgc> <test_data.json> [criticality_threshold] [output_log_file]" << std::endl;
+        std::cerr << "       " << argv[0] << " --compile <fault_model.json> [snapshot.rtfpgc]" << std::endl;
         return 1;
     }
 
@@ -68,49 +169,70 @@ int main(int argc, char* argv[]) {
     // ---------------------------------------------------------
     // 1. Load and Parse Static Fault Model
     // ---------------------------------------------------------
-    // Define the path to the fault model file.
+    // Define the path to the fault model file. A compiled snapshot (.rtfpgc) is loaded directly; a JSON
+    // model is loaded from its snapshot cache next to it when the JSON is unchanged since it was written.
     std::string filePath = argv[1];
-    std::ifstream inputFile(filePath);
+    std::optional<rTFPGModel> loadedModel;
 
-    // Error handling for file opening.
-    if (!inputFile.is_open()) {
-        std::cerr << "Error: Could not open model file: " << filePath << std::endl;
-        return 1;
-    }
+    if (isSnapshotPath(filePath)) {
+        try {
+            loadedModel = ModelSnapshot::load(filePath);
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+    } else {
+        std::string modelText;
+        // Error handling for file opening.
+        if (!readFile(filePath, modelText)) {
+            std::cerr << "Error: Could not open model file: " << filePath << std::endl;
+            return 1;
+        }
 
-    // Parse the JSON data from the file.
-    json modelData;
-    try {
-        modelData = json::parse(inputFile);
-    } catch (const json::parse_error& e) {
-        std::cerr << "Model JSON Parse Error: " << e.what() << std::endl;
-        return 1;
+        const uint64_t sourceHash = ModelSnapshot::hash(modelText.data(), modelText.size());
+        const std::string cachePath = ModelSnapshot::cachePathFor(filePath);
+        loadedModel = ModelSnapshot::loadIfFresh(cachePath, sourceHash);
+
+        if (!loadedModel) {
+            // REQ-MOD-01 to 04: Stream the static graph definitions out of the JSON text.
+            try {
+                loadedModel.emplace(ModelLoader::parse(modelText));
+            } catch (const json::parse_error& e) {
+                std::cerr << "Model JSON Parse Error: " << e.what() << std::endl;
+                return 1;
+            } catch (const std::exception& e) {
+                std::cerr << "Model Error: " << e.what() << std::endl;
+                return 1;
+            }
+
+            // The cache is an optimization only; a read-only model directory just means no cache.
+            try {
+                ModelSnapshot::write(*loadedModel, sourceHash, cachePath);
+            } catch (const std::exception& e) {
+                std::cerr << "Warning: " << e.what() << std::endl;
+            }
+        }
     }
 
     // Initialize System Objects
-    // REQ-MOD-01 to 04: Load static graph definitions from the parsed JSON data.
-    rTFPGModel rtfpg(modelData); 
+    rTFPGModel& rtfpg = *loadedModel;
     
     // REQ-IN-03: Initialize the signal ingestor, which maps signal names to internal IDs for efficient lookup.
-    SignalIngestor ingestor(modelData); 
+    SignalIngestor ingestor(rtfpg); 
 
     // REQ-ENG-01: Initialize the Logic Engine, providing it with the model and a reference to the ingestor for signal history.
     LogicEngine engine(rtfpg, ingestor); 
+    engine.setWorkerThreads(worker_threads);
 
     // REQ-PROG-02: Initialize the Prognosis Manager with the fault model to calculate future failure states.
     PrognosisManager prognosis(rtfpg); 
+    prognosis.setWorkerThreads(worker_threads);
 
     std::cout << "System Initialized. Nodes: " << rtfpg.getNodes().size() << std::endl;
 
-    // Create lookup maps for detailed reporting
-    std::map<std::string, Node> node_lookup;
-    for (const auto& node : rtfpg.getNodes()) {
-        node_lookup[node.id] = node;
-    }
-    std::map<std::string, Signal> signal_lookup;
-    for (const auto& sig : rtfpg.getSignals()) {
-        signal_lookup[sig.id] = sig;
-    }
+    // Reporting works on dense node indices: rtfpg.getNodes()[i] pairs with engine state i.
+    const auto& nodes = rtfpg.getNodes();
+    const auto& records = rtfpg.getNodeRecords(); // Per-step scans read these; `nodes` is for names
 
     // ---------------------------------------------------------
     // 2. Load Test Data Stream
@@ -125,64 +247,45 @@ int main(int argc, char* argv[]) {
         return 1;
     }
 
-    // Parse the JSON test data from the file.
-    json testData;
-    try {
-        testData = json::parse(testDataFile);
-    } catch (const json::parse_error& e) {
-        std::cerr << "Test Data JSON Parse Error: " << e.what() << std::endl;
-        return 1;
-    }
+    // The test data is streamed: each event is processed as soon as it has been read, so only the
+    // events held by the reorder stage (if any) are in memory at once.
+    auto startSimulation = [&](const json& scenario_id) {
+        std::cout << "Starting Simulation: " << scenario_id << "\n" << std::endl;
 
-    std::cout << "Starting Simulation: " << testData["scenario_id"] << "\n" << std::endl;
-
-    // ---------------------------------------------------------
-    // 3. Real-Time Processing Loop
-    // ---------------------------------------------------------
-    // Define a criticality threshold for prognosis. Any node with a criticality level
-    // greater than or equal to this value is considered a critical failure.
+        // ---------------------------------------------------------
+        // 3. Real-Time Processing Loop
+        // ---------------------------------------------------------
+        // Define a criticality threshold for prognosis. Any node with a criticality level
+        // greater than or equal to this value is considered a critical failure.
 
-    std::cout << "\nUsing Criticality Threshold: " << criticality_threshold << std::endl;
+        std::cout << "\nUsing Criticality Threshold: " << criticality_threshold << std::endl;
+    };
 
-    std::set<std::string> last_active_symptoms;
-    std::map<std::string, double> last_robustness_scores;
+    // Change detection is keyed by node index; IDs are only materialized when a report is printed.
+    std::set<size_t> last_active_symptoms;
+    std::map<size_t, double> last_robustness_scores;
     double last_ttc = std::numeric_limits<double>::infinity();
 
-    // Iterate through each event in the "data_stream" array of the test data.
-    for (const auto& event : testData["data_stream"]) {
-        // Skip comment blocks in the JSON stream, which are used for documentation.
-        if (event.contains("comment")) continue;
-
-        // A. Construct DataSample (REQ-IN-01)
-        // Create a DataSample struct for the current event.
-        DataSample sample;
-        sample.timestamp_ms = event["timestamp_ms"];
-        sample.parameterID = event["parameter_id"];
-        // The 'is_failure_mode' field distinguishes between sensor readings and fault injections.
-        sample.is_failure_mode = event.value("is_failure_mode", false);
-        
-        // Handle boolean vs double inputs (Source 213: signals are continuous x: N -> R^n)
-        // Convert boolean JSON values to 1.0 or 0.0 to treat all signals as continuous values.
-        if (event["value"].is_boolean()) {
-            sample.value = event["value"] ? 1.0 : 0.0;
-        } else {
-            sample.value = event["value"];
-        }
-
-        // B. Ingest Signal (REQ-IN-02)
-        // Add the current sample to the ingestor's buffer. This history is used by the Logic Engine.
-        ingestor.ingest(sample);
-
+    // C-F. Diagnose and report as of `sample`, the last sample ingested.
+    auto diagnoseAndReport = [&](const DataSample& sample) {
         // C. Run Diagnosis (REQ-ENG-04)
         // The Logic Engine processes the accumulated signal history to find any active failure hypotheses.
-        auto diagnoses = engine.findActiveHypotheses();
-        const auto& nodeStates = engine.getNodeStates();
+        // The results refer to nodes by index; names are resolved below, only when a report is rendered.
+        const auto& diagnoses = engine.findActiveHypotheses();
+        // Samples the engine has evaluated are only kept within the model's propagation horizon.
+        ingestor.compact(engine.getCursor());
+        const auto& nodeStates = engine.getDenseNodeStates();
+        // Resolves a node ID to its current state, or nullptr if unknown.
+        auto stateOf = [&](const std::string& id) -> const NodeState* {
+            int idx = rtfpg.getNodeIndex(id);
+            return idx >= 0 ? &nodeStates[static_cast<size_t>(idx)] : nullptr;
+        };
 
         // 1. Check for changes in active symptoms
-        std::set<std::string> current_active_symptoms;
-        for (const auto& [id, state] : nodeStates) {
-            if (state.is_active && node_lookup.count(id) && node_lookup.at(id).type == NodeType::Discrepancy) {
-                current_active_symptoms.insert(id);
+        std::set<size_t> current_active_symptoms;
+        for (size_t i = 0; i < nodes.size(); ++i) {
+            if (nodeStates[i].is_active && records[i].type == NodeType::Discrepancy) {
+                current_active_symptoms.insert(i);
             }
         }
         bool symptoms_changed = (current_active_symptoms != last_active_symptoms);
@@ -190,11 +293,12 @@ int main(int argc, char* argv[]) {
 
         // 2. Check for changes in robustness scores
         bool robustness_changed = false;
-        std::map<std::string, double> current_robustness_scores;
+        std::map<size_t, double> current_robustness_scores;
         for (const auto& diag : diagnoses) {
-            current_robustness_scores[diag.node.id] = diag.robustness;
-            if (last_robustness_scores.find(diag.node.id) == last_robustness_scores.end() ||
-                std::abs(last_robustness_scores[diag.node.id] - diag.robustness) > 1e-6) {
+            const size_t diag_id = diag.node_index;
+            current_robustness_scores[diag_id] = diag.robustness;
+            if (last_robustness_scores.find(diag_id) == last_robustness_scores.end() ||
+                std::abs(last_robustness_scores[diag_id] - diag.robustness) > 1e-6) {
                 robustness_changed = true;
             }
         }
@@ -245,22 +349,20 @@ int main(int argc, char* argv[]) {
             
             std::cout << "SYSTEM PROGNOSIS:\n";
             
-            // Check for CURRENTLY ACTIVE critical nodes
+            // Check for CURRENTLY ACTIVE critical nodes. The front is ordered most critical first
+            // (ties in node ID order), so the first active node on it is the one to report.
             std::string active_critical_id = "";
-            int max_crit_level = -1;
-            for (const auto& [id, state] : nodeStates) {
-                if (state.is_active && node_lookup.count(id)) {
-                    int cl = node_lookup.at(id).criticality_level;
-                    if (cl >= criticality_threshold && cl > max_crit_level) {
-                        max_crit_level = cl;
-                        active_critical_id = id;
-                    }
+            for (size_t i : rtfpg.GetCriticalityFront(criticality_threshold)) {
+                if (nodeStates[i].is_active) {
+                    active_critical_id = nodes[i].id;
+                    break;
                 }
             }
 
             if (!active_critical_id.empty()) {
                 std::cout << "   - CRITICAL FAILURE ACTIVE (Target: " << active_critical_id << ").\n";
-                bool target_is_active = nodeStates.count(target_id) && nodeStates.at(target_id).is_active;
+                const NodeState* target_state = stateOf(target_id);
+                bool target_is_active = target_state && target_state->is_active;
                 if (ttc > 0 && ttc != std::numeric_limits<double>::infinity() && target_id != active_critical_id && !target_is_active) {
                     std::cout << "   - WARNING: Cascading Failure expected in " << ttc << " ms (Target: " << target_id << ").\n";
                 }
@@ -274,43 +376,39 @@ int main(int argc, char* argv[]) {
             std::cout << "\n";
 
             // Helper lambda to determine symptom status
-            auto get_symptom_status = [&](const std::string& id, double current_time) -> std::pair<std::string, std::string> {
-                if (nodeStates.count(id) && nodeStates.at(id).is_active) {
+            auto get_symptom_status = [&](size_t symptom, double current_time) -> std::pair<std::string, std::string> {
+                if (nodeStates[symptom].is_active) {
                     return {"CONFIRMED", ""};
                 }
                 
                 // Check parents
-                std::vector<const Edge*> incoming;
-                for (const auto& edge : rtfpg.getEdges()) {
-                    if (edge.to == id) incoming.push_back(&edge);
-                }
+                const auto incoming = rtfpg.getGraph().parents(symptom);
                 
                 if (incoming.empty()) return {"MISSING", "No parents"};
 
-                const auto& node_def = node_lookup.at(id);
-                bool is_and = (node_def.gate_type == GateType::AND);
+                bool is_and = (records[symptom].gate_type == GateType::AND);
                 
                 if (is_and) {
                     // AND Gate: All parents must be active
-                    for (const auto* edge : incoming) {
-                        if (!nodeStates.count(edge->from) || !nodeStates.at(edge->from).is_active) {
-                            return {"UNREACHABLE", "Parent " + edge->from + " is inactive"};
+                    for (const auto& edge : incoming) {
+                        if (!nodeStates[edge.node_index].is_active) {
+                            return {"UNREACHABLE", "Parent " + nodes[edge.node_index].id + " is inactive"};
                         }
                     }
                     // All parents active. Check timing of the LATEST parent trigger.
                     double max_act_time = -1.0;
-                    const Edge* triggering_edge = nullptr;
-                    for (const auto* edge : incoming) {
-                        if (nodeStates.at(edge->from).activation_time_ms > max_act_time) {
-                            max_act_time = nodeStates.at(edge->from).activation_time_ms;
-                            triggering_edge = edge;
+                    size_t triggering_edge = incoming.size(); // Position in incoming; none yet
+                    for (size_t e = 0; e < incoming.size(); ++e) {
+                        if (nodeStates[incoming[e].node_index].activation_time_ms > max_act_time) {
+                            max_act_time = nodeStates[incoming[e].node_index].activation_time_ms;
+                            triggering_edge = e;
                         }
                     }
                     
-                    if (triggering_edge) {
+                    if (triggering_edge < incoming.size()) {
                         double delta = current_time - max_act_time;
-                        if (delta < triggering_edge->time_min_ms) return {"PENDING", "Propagation Delay"};
-                        if (delta > triggering_edge->time_max_ms) return {"MISSING", "Overdue"};
+                        if (delta < incoming[triggering_edge].time_min_ms) return {"PENDING", "Propagation Delay"};
+                        if (delta > incoming[triggering_edge].time_max_ms) return {"MISSING", "Overdue"};
                         return {"MISSING", "Should be active"};
                     }
                 } else {
@@ -319,12 +417,13 @@ int main(int argc, char* argv[]) {
                     bool any_overdue = false;
                     bool all_pending = true;
                     
-                    for (const auto* edge : incoming) {
-                        if (nodeStates.count(edge->from) && nodeStates.at(edge->from).is_active) {
+                    for (const auto& edge : incoming) {
+                        const NodeState& parent = nodeStates[edge.node_index];
+                        if (parent.is_active) {
                             any_active = true;
-                            double delta = current_time - nodeStates.at(edge->from).activation_time_ms;
-                            if (delta > edge->time_max_ms) any_overdue = true;
-                            if (delta >= edge->time_min_ms) all_pending = false;
+                            double delta = current_time - parent.activation_time_ms;
+                            if (delta > edge.time_max_ms) any_overdue = true;
+                            if (delta >= edge.time_min_ms) all_pending = false;
                         }
                     }
                     
@@ -350,7 +449,8 @@ int main(int argc, char* argv[]) {
                 int idx = 1;
 
                 for (const auto& d : tier1) {
-                    std::cout << "    " << idx++ << ". " << d.node.name << " (" << d.node.id << ")\n";
+                    const Node& d_node = nodes[d.node_index];
+                    std::cout << "    " << idx++ << ". " << d_node.name << " (" << d_node.id << ")\n";
                     // Tier 1 is 100% confidence, so status is generally Verified.
                     // But we can check for pending items.
                     // Since Plausibility=1.0, there are no MISSING items (consistent=expected).
@@ -358,11 +458,12 @@ int main(int argc, char* argv[]) {
                     std::cout << "       > Status: VERIFIED\n";
                     
                     std::cout << "       > Active Symptoms:\n";
-                    for (const auto& id : d.consistent_symptoms) {
-                        std::string name = node_lookup.count(id) ? node_lookup.at(id).name : "Unknown";
+                    for (size_t s : d.consistent_symptoms) {
+                        const std::string& id = nodes[s].id;
+                        const std::string& name = nodes[s].name;
                         std::string time_str = "Inactive";
-                        if (nodeStates.count(id) && nodeStates.at(id).is_active) {
-                            time_str = std::to_string(nodeStates.at(id).activation_time_ms) + "ms";
+                        if (nodeStates[s].is_active) {
+                            time_str = std::to_string(nodeStates[s].activation_time_ms) + "ms";
                         }
                         std::cout << "         - " << id << " (" << name << ") activated at " << time_str << "\n";
                     }
@@ -378,27 +479,28 @@ int main(int argc, char* argv[]) {
                 std::cout << "POTENTIAL FAULTS:\n";
                 
                 for (const auto& d : tier2) {
+                    const Node& d_node = nodes[d.node_index];
                     // Determine Hypothesis Status
                     std::string hyp_status = "CONFIRMED";
                     int pending_cnt = 0;
                     int missing_cnt = 0;
                     int unreachable_cnt = 0;
                     
-                    for (const auto& id : d.expected_symptoms) {
-                        auto status = get_symptom_status(id, sample.timestamp_ms);
+                    for (size_t s : d.expected_symptoms) {
+                        auto status = get_symptom_status(s, sample.timestamp_ms);
                         if (status.first == "PENDING") pending_cnt++;
                         else if (status.first == "UNREACHABLE") unreachable_cnt++;
                         else if (status.first == "MISSING") missing_cnt++;
                     }
 
-                    if (d.node.type == NodeType::FailureMode) {
+                    if (records[d.node_index].type == NodeType::FailureMode) {
                         
                         // NEW LOGIC: Check if the Root Cause itself is active
                         // (i.e., does this fault directly cause any currently active symptom?)
                         bool root_cause_active = false;
-                        for (const auto& s_id : d.consistent_symptoms) {
-                            for (const auto& edge : rtfpg.getEdges()) {
-                                if (edge.from == d.node.id && edge.to == s_id) {
+                        for (size_t s : d.consistent_symptoms) {
+                            for (const auto& edge : rtfpg.getGraph().children(d.node_index)) {
+                                if (edge.node_index == s) {
                                     root_cause_active = true;
                                     break;
                                 }
@@ -433,32 +535,27 @@ int main(int argc, char* argv[]) {
                         else hyp_status = "CONFIRMED";
                     }
 
-                    std::cout << "[?] " << d.node.name << " (" << d.node.id << ") [Confidence: " << (d.plausibility * 100.0) << "%]\n";
+                    std::cout << "[?] " << d_node.name << " (" << d_node.id << ") [Confidence: " << (d.plausibility * 100.0) << "%]\n";
                     std::cout << "    > Status: " << hyp_status << "\n";
                     
                     std::cout << "    > Active Symptoms:\n";
-                    for (const auto& id : d.consistent_symptoms) {
-                        std::string name = node_lookup.count(id) ? node_lookup.at(id).name : "Unknown";
+                    for (size_t s : d.consistent_symptoms) {
+                        const std::string& id = nodes[s].id;
+                        const std::string& name = nodes[s].name;
                         std::string time_str = "Inactive";
-                        if (nodeStates.count(id) && nodeStates.at(id).is_active) {
-                            time_str = std::to_string(nodeStates.at(id).activation_time_ms) + "ms";
+                        if (nodeStates[s].is_active) {
+                            time_str = std::to_string(nodeStates[s].activation_time_ms) + "ms";
                         }
                         std::cout << "      - " << id << " (" << name << ") activated at " << time_str << "\n";
                     }
 
                     std::cout << "    > Missing / Inactive Symptoms:\n";
-                    for (const auto& id : d.expected_symptoms) {
-                        bool active = false;
-                        double rob = 0.0;
-                        if (nodeStates.count(id)) {
-                            active = nodeStates.at(id).is_active;
-                            rob = nodeStates.at(id).robustness;
-                        }
-                        
-                        if (!active) {
-                            std::string name = node_lookup.count(id) ? node_lookup.at(id).name : "Unknown";
+                    for (size_t s : d.expected_symptoms) {
+                        if (!nodeStates[s].is_active) {
+                            const std::string& id = nodes[s].id;
+                            const std::string& name = nodes[s].name;
                             
-                            auto status = get_symptom_status(id, sample.timestamp_ms);
+                            auto status = get_symptom_status(s, sample.timestamp_ms);
                             if (status.first == "UNREACHABLE") {
                                 std::cout << "      - " << id << " (" << name << ") is UNREACHABLE (" << status.second << ")\n";
                             } else if (status.first == "PENDING") {
@@ -477,19 +574,20 @@ int main(int argc, char* argv[]) {
             std::cout << "[TIER 3] UNEXPLAINED SYMPTOMS:\n";
             std::cout << "------------------------------------------------------------------------------\n";
             
-            std::set<std::string> explained_symptoms;
+            std::vector<bool> explained_symptoms(nodes.size(), false);
             for (const auto& d : tier1) {
-                for (const auto& s : d.consistent_symptoms) explained_symptoms.insert(s);
+                for (size_t s : d.consistent_symptoms) explained_symptoms[s] = true;
             }
             for (const auto& d : tier2) {
-                for (const auto& s : d.consistent_symptoms) explained_symptoms.insert(s);
+                for (size_t s : d.consistent_symptoms) explained_symptoms[s] = true;
             }
 
             bool found_unexplained = false;
-            for (const auto& [id, state] : nodeStates) {
-                if (state.is_active && node_lookup.count(id) && node_lookup.at(id).type == NodeType::Discrepancy) {
-                    if (explained_symptoms.find(id) == explained_symptoms.end()) {
-                        std::string name = node_lookup.at(id).name;
+            for (size_t i = 0; i < nodes.size(); ++i) {
+                if (nodeStates[i].is_active && records[i].type == NodeType::Discrepancy) {
+                    const std::string& id = nodes[i].id;
+                    if (!explained_symptoms[i]) {
+                        const std::string& name = nodes[i].name;
                         std::cout << "    - " << id << " (" << name << ")\n";
                         std::cout << "      > Analysis: Active but not predicted by selected hypotheses.\n";
                         std::cout << "      > Potential Causes: Signal Noise, Unmodeled Fault, or Hypothesis Truncation.\n";
@@ -502,10 +600,107 @@ int main(int argc, char* argv[]) {
             }
             std::cout << "\n";
         }
+    };
+
+    // Batch replay (--checkpoint-ms): samples collected since the last checkpoint.
+    std::vector<DataSample> batch;
+    uint64_t next_checkpoint_ms = 0; // Checkpoint that closes the open batch, aligned to the grid
+    // Evaluates the batch in one pass (activations keep their own timestamps), then reports once,
+    // as of its last sample.
+    auto closeBatch = [&]() {
+        ingestor.ingest(batch.data(), batch.size());
+        engine.advance();
+        diagnoseAndReport(batch.back());
+        batch.clear();
+    };
+
+    // B. Ingest Signal (REQ-IN-02), in timestamp order once past the reorder stage.
+    // Add the sample to the ingestor's buffer. This history is used by the Logic Engine.
+    auto processSample = [&](const DataSample& sample) {
+        if (checkpoint_ms == 0) {
+            ingestor.ingest(sample);
+            diagnoseAndReport(sample);
+            return;
+        }
+        // The first sample at or past the next checkpoint closes the batch before it.
+        if (!batch.empty() && sample.timestamp_ms >= next_checkpoint_ms) closeBatch();
+        // A new batch ends at the first checkpoint after its first sample, wherever the stream starts.
+        if (batch.empty()) next_checkpoint_ms = (sample.timestamp_ms / checkpoint_ms + 1) * checkpoint_ms;
+        batch.push_back(sample);
+    };
+
+    // A. Construct DataSamples (REQ-IN-01) from the "data_stream" array of the test data.
+    // With --max-lateness-ms, the feed passes through a reorder stage first, which releases samples
+    // in timestamp order as the watermark advances; samples later than the bound are dropped and counted.
+    std::optional<ReorderBuffer> reorder;
+    if (max_lateness_ms) reorder.emplace(*max_lateness_ms);
+    auto readEvent = [&](const json& event) {
+        // Skip comment blocks in the JSON stream, which are used for documentation.
+        if (event.contains("comment")) return;
+
+        DataSample sample;
+        sample.timestamp_ms = event["timestamp_ms"];
+        sample.parameterID = event["parameter_id"];
+        // The 'is_failure_mode' field distinguishes between sensor readings and fault injections.
+        sample.is_failure_mode = event.value("is_failure_mode", false);
+        
+        // Handle boolean vs double inputs (Source 213: signals are continuous x: N -> R^n)
+        // Convert boolean JSON values to 1.0 or 0.0 to treat all signals as continuous values.
+        if (event["value"].is_boolean()) {
+            sample.value = event["value"] ? 1.0 : 0.0;
+        } else {
+            sample.value = event["value"];
+        }
+
+        if (!reorder) {
+            processSample(sample);
+            return;
+        }
+        reorder->push(sample);
+        while (reorder->pop(sample)) processSample(sample);
+    };
+
+    try {
+        DataStreamReader::read(testDataFile, startSimulation, readEvent);
+    } catch (const json::parse_error& e) {
+        std::cerr << "Test Data JSON Parse Error: " << e.what() << std::endl;
+        return 1;
+    } catch (const std::invalid_argument& e) {
+        std::cerr << "Test Data Error: " << e.what() << std::endl;
+        return 1;
     }
+    // End of stream: release what the reorder stage still holds, then close the last batch.
+    if (reorder) {
+        DataSample sample;
+        while (reorder->flush(sample)) processSample(sample);
+    }
+    if (!batch.empty()) closeBatch();
 
     std::cout << "\nSimulation Complete." << std::endl;
 
+    // Work counters go to stderr so they never mix into the diagnostic report/log.
+    if (print_stats) {
+        const EngineCounters& counters = engine.getCounters();
+        std::cerr << "Engine: " << counters.samples_evaluated << " samples, " << counters.diagnosis_calls
+                  << " diagnosis calls, " << counters.diagnosis_cache_hits << " cache hits ("
+                  << std::fixed << std::setprecision(1) << counters.cacheHitRate() * 100.0 << "%), "
+                  << counters.diagnosis_rescores << " rescores" << std::endl;
+        std::cerr << "Ingestor: " << ingestor.getArrivalCount() << " samples, " << ingestor.getRetainedBytes()
+                  << " bytes retained (horizon " << ingestor.getRetentionHorizon() << " ms)" << std::endl;
+        for (size_t i = 0; i < ingestor.getSignalCount(); ++i) {
+            int id = static_cast<int>(i);
+            std::cerr << "  " << ingestor.getParameterId(id) << ": " << ingestor.getRetainedSampleCount(id)
+                      << " samples, " << ingestor.getRetainedBytes(id) << " bytes" << std::endl;
+        }
+        if (reorder) {
+            const ReorderStats& stats = reorder->getStats();
+            std::cerr << "Reorder: " << stats.received << " samples, " << stats.reordered << " reordered, "
+                      << stats.late_dropped << " dropped late (bound " << reorder->getMaxLateness()
+                      << " ms, worst lateness " << stats.max_observed_lateness_ms << " ms, peak "
+                      << stats.peak_buffered << " buffered)" << std::endl;
+        }
+    }
+
     if (cout_backup) {
         std::cout.rdbuf(cout_backup);
     }
@@ -1,111 +1,572 @@
 #include "rTFPGModel.h"
-#include <algorithm> // For std::copy_if
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+#include <unordered_set>
+
+ComparisonOp parseComparisonOp(const std::string& op) {
+    if (op == "<") return ComparisonOp::Less;
+    if (op == ">") return ComparisonOp::Greater;
+    if (op == "<=") return ComparisonOp::LessEqual;
+    if (op == ">=") return ComparisonOp::GreaterEqual;
+    if (op == "==") return ComparisonOp::Equal;
+    if (op == "!=") return ComparisonOp::NotEqual;
+    throw std::invalid_argument("Unsupported predicate operator '" + op + "'");
+}
+
+const char* comparisonOpSymbol(ComparisonOp op) {
+    switch (op) {
+        case ComparisonOp::Less: return "<";
+        case ComparisonOp::Greater: return ">";
+        case ComparisonOp::LessEqual: return "<=";
+        case ComparisonOp::GreaterEqual: return ">=";
+        case ComparisonOp::Equal: return "==";
+        case ComparisonOp::NotEqual: return "!=";
+    }
+    return "?";
+}
+
+Signal parseSignal(const nlohmann::json& j_signal) {
+    Signal signal;
+    signal.id = j_signal.at("id").get<std::string>();
+    signal.source_name = j_signal.at("source_name").get<std::string>();
+    signal.type = j_signal.at("type").get<std::string>();
+    signal.units = j_signal.at("units").get<std::string>();
+    signal.range_min = j_signal.value("range_min", 0.0);
+    signal.range_max = j_signal.value("range_max", 1.0);
+    return signal;
+}
+
+NodeDefinition parseNode(const nlohmann::json& j_node) {
+    NodeDefinition node;
+    node.id = j_node.at("id").get<std::string>();
+    node.name = j_node.at("name").get<std::string>();
+    node.description = j_node.value("description", "");
+
+    std::string type_str = j_node.at("type").get<std::string>();
+    if (type_str == "FailureMode") {
+        node.type = NodeType::FailureMode;
+    } else { // "Discrepancy"
+        node.type = NodeType::Discrepancy;
+
+        // Parse Discrepancy-specific fields.
+        std::string gate_type_str = j_node.at("gate_type").get<std::string>();
+        if (gate_type_str == "OR") {
+            node.gate_type = GateType::OR;
+        } else { // "AND"
+            node.gate_type = GateType::AND;
+        }
+        node.criticality_level = j_node.at("criticality_level").get<int>();
+
+
+        // Parse the predicate which defines the condition for the discrepancy to be active.
+        const auto& j_predicate = j_node.at("predicate");
+        Predicate p;
+        p.signal_ref = j_predicate.at("signal_ref").get<std::string>();
+        p.op = j_predicate.at("operator").get<std::string>();
+        p.threshold = j_predicate.at("threshold").get<double>();
+        p.comparison = parseComparisonOp(p.op);
+        node.predicate = p;
+    }
+
+    // The comment below is outdated as criticality_level is now parsed.
+    // If it were present, it would be parsed here, e.g.:
+    // node.criticality_level = j_node.value("criticality_level", 0);
+
+    return node;
+}
+
+Edge parseEdge(const nlohmann::json& j_edge) {
+    Edge edge;
+    edge.from = j_edge.at("from").get<std::string>();
+    edge.to = j_edge.at("to").get<std::string>();
+    edge.time_min_ms = j_edge.at("time_min_ms").get<int>();
+    edge.time_max_ms = j_edge.at("time_max_ms").get<int>();
+    return edge;
+}
+
+SubgraphTemplate parseTemplate(const nlohmann::json& j_template) {
+    SubgraphTemplate subgraph;
+    subgraph.id = j_template.at("id").get<std::string>();
+    for (const auto& j_node : j_template.at("nodes")) {
+        subgraph.nodes.push_back(parseNode(j_node));
+    }
+    if (j_template.contains("edges")) {
+        for (const auto& j_edge : j_template.at("edges")) {
+            subgraph.edges.push_back(parseEdge(j_edge));
+        }
+    }
+    return subgraph;
+}
+
+SubgraphInstance parseInstance(const nlohmann::json& j_instance) {
+    SubgraphInstance instance;
+    instance.id = j_instance.at("id").get<std::string>();
+    instance.template_id = j_instance.at("template").get<std::string>();
+    if (j_instance.contains("bindings")) {
+        for (const auto& [placeholder, signal] : j_instance.at("bindings").items()) {
+            instance.bindings.emplace(placeholder, signal.get<std::string>());
+        }
+    }
+    return instance;
+}
+
+void instantiateTemplates(const std::vector<SubgraphTemplate>& templates, const std::vector<SubgraphInstance>& instances,
+                          std::vector<NodeDefinition>& nodes, std::vector<Edge>& edges) {
+    std::unordered_map<std::string, const SubgraphTemplate*> by_id;
+    for (const SubgraphTemplate& subgraph : templates) {
+        if (!by_id.emplace(subgraph.id, &subgraph).second) {
+            throw std::invalid_argument("Duplicate template ID '" + subgraph.id + "'");
+        }
+        std::unordered_set<std::string> local_ids;
+        for (const NodeDefinition& node : subgraph.nodes) local_ids.insert(node.id);
+        for (const Edge& edge : subgraph.edges) {
+            for (const std::string* end : {&edge.from, &edge.to}) {
+                if (!local_ids.count(*end)) {
+                    throw std::invalid_argument("Template '" + subgraph.id + "' edge '" + edge.from + "' -> '" + edge.to +
+                                                "' references unknown node '" + *end + "'");
+                }
+            }
+        }
+    }
+
+    size_t node_total = nodes.size();
+    size_t edge_total = edges.size();
+    for (const SubgraphInstance& instance : instances) {
+        auto found = by_id.find(instance.template_id);
+        if (found == by_id.end()) {
+            throw std::invalid_argument("Instance '" + instance.id + "' references unknown template '" + instance.template_id + "'");
+        }
+        node_total += found->second->nodes.size();
+        edge_total += found->second->edges.size();
+    }
+    nodes.reserve(node_total);
+    edges.reserve(edge_total);
+
+    for (const SubgraphInstance& instance : instances) {
+        const SubgraphTemplate& subgraph = *by_id.at(instance.template_id);
+        const std::string prefix = instance.id + ".";
+        for (const NodeDefinition& local : subgraph.nodes) {
+            NodeDefinition node = local;
+            node.id = prefix + local.id;
+            node.name = prefix + local.name;
+            if (node.predicate) {
+                auto bound = instance.bindings.find(local.predicate->signal_ref);
+                if (bound == instance.bindings.end()) {
+                    throw std::invalid_argument("Instance '" + instance.id + "' does not bind signal placeholder '" +
+                                                local.predicate->signal_ref + "' of template '" + subgraph.id + "'");
+                }
+                node.predicate->signal_ref = bound->second;
+            }
+            nodes.push_back(std::move(node));
+        }
+    }
+    for (const SubgraphInstance& instance : instances) {
+        const SubgraphTemplate& subgraph = *by_id.at(instance.template_id);
+        const std::string prefix = instance.id + ".";
+        for (const Edge& local : subgraph.edges) {
+            edges.push_back({prefix + local.from, prefix + local.to, local.time_min_ms, local.time_max_ms});
+        }
+    }
+}
 
 rTFPGModel::rTFPGModel(const nlohmann::json& model_data) {
+    std::vector<NodeDefinition> nodes;
+
     // Parse the "signals" array from the JSON model.
     if (model_data.contains("signals") && model_data["signals"].is_array()) {
         for (const auto& j_signal : model_data["signals"]) {
-            Signal signal;
-            signal.id = j_signal.at("id").get<std::string>();
-            signal.source_name = j_signal.at("source_name").get<std::string>();
-            signal.type = j_signal.at("type").get<std::string>();
-            signal.units = j_signal.at("units").get<std::string>();
-            signal.range_min = j_signal.value("range_min", 0.0);
-            signal.range_max = j_signal.value("range_max", 1.0);
-            m_signals.push_back(signal);
+            m_signals.push_back(parseSignal(j_signal));
         }
     }
 
     // REQ-MOD-03 & REQ-MOD-02: Parse the "nodes" array (Failure Modes and Discrepancies).
     if (model_data.contains("nodes") && model_data["nodes"].is_array()) {
         for (const auto& j_node : model_data["nodes"]) {
-            Node node;
-            node.id = j_node.at("id").get<std::string>();
-            node.name = j_node.at("name").get<std::string>();
-
-            std::string type_str = j_node.at("type").get<std::string>();
-            if (type_str == "FailureMode") {
-                node.type = NodeType::FailureMode;
-            } else { // "Discrepancy"
-                node.type = NodeType::Discrepancy;
-
-                // Parse Discrepancy-specific fields.
-                std::string gate_type_str = j_node.at("gate_type").get<std::string>();
-                if (gate_type_str == "OR") {
-                    node.gate_type = GateType::OR;
-                } else { // "AND"
-                    node.gate_type = GateType::AND;
-                }
-                node.criticality_level = j_node.at("criticality_level").get<int>();
+            nodes.push_back(parseNode(j_node));
+        }
+    }
+
+    // REQ-MOD-01: Parse the "edges" array, which defines the causal and temporal relationships between nodes.
+    if (model_data.contains("edges") && model_data["edges"].is_array()) {
+        for (const auto& j_edge : model_data["edges"]) {
+            m_edges.push_back(parseEdge(j_edge));
+        }
+    }
 
+    // Expand the "instances" of sub-graph "templates" after the explicit nodes and edges.
+    std::vector<SubgraphTemplate> templates;
+    std::vector<SubgraphInstance> instances;
+    if (model_data.contains("templates") && model_data["templates"].is_array()) {
+        for (const auto& j_template : model_data["templates"]) {
+            templates.push_back(parseTemplate(j_template));
+        }
+    }
+    if (model_data.contains("instances") && model_data["instances"].is_array()) {
+        for (const auto& j_instance : model_data["instances"]) {
+            instances.push_back(parseInstance(j_instance));
+        }
+    }
+    instantiateTemplates(templates, instances, nodes, m_edges);
 
-                // Parse the predicate which defines the condition for the discrepancy to be active.
-                const auto& j_predicate = j_node.at("predicate");
-                Predicate p;
-                p.signal_ref = j_predicate.at("signal_ref").get<std::string>();
-                p.op = j_predicate.at("operator").get<std::string>();
-                p.threshold = j_predicate.at("threshold").get<double>();
-                node.predicate = p;
-            }
+    storeNodes(nodes);
+    validate(nodes);
+    compileGraph();
+}
 
-            // The comment below is outdated as criticality_level is now parsed.
-            // If it were present, it would be parsed here, e.g.:
-            // node.criticality_level = j_node.value("criticality_level", 0);
+rTFPGModel::rTFPGModel(std::vector<Signal> signals, std::vector<NodeDefinition> nodes, std::vector<Edge> edges)
+    : m_signals(std::move(signals)), m_edges(std::move(edges)) {
+    storeNodes(nodes);
+    validate(nodes);
+    compileGraph();
+}
 
-            m_nodes.push_back(node);
+rTFPGModel::rTFPGModel(std::vector<Signal> signals, std::vector<NodeDefinition> nodes, std::vector<Edge> edges, CompiledGraph graph)
+    : m_signals(std::move(signals)), m_edges(std::move(edges)), m_graph(std::move(graph)) {
+    storeNodes(nodes);
+    // The snapshot passed its checksum but may come from a faulty writer: check the references as a
+    // JSON load would, and that the stored graph covers exactly these nodes and (all resolved) edges.
+    validate(nodes);
+    if (m_graph.nodeCount() != m_nodes.size() || m_graph.edgeCount() != m_edges.size()) {
+        throw std::invalid_argument("Compiled graph does not match the node and edge lists");
+    }
+    // compileGraph() keeps each node's edges in list order, so every edge must sit at the next unused
+    // position of its source's children and its target's parents. With the counts equal, that leaves
+    // no position unmatched.
+    std::vector<uint32_t> out_used(m_nodes.size(), 0);
+    std::vector<uint32_t> in_used(m_nodes.size(), 0);
+    for (const Edge& edge : m_edges) {
+        size_t from = static_cast<size_t>(getNodeIndex(edge.from));
+        size_t to = static_cast<size_t>(getNodeIndex(edge.to));
+        CompiledGraph::EdgeRange children = m_graph.children(from);
+        CompiledGraph::EdgeRange parents = m_graph.parents(to);
+        if (out_used[from] == children.size() || in_used[to] == parents.size()) {
+            throw std::invalid_argument("Compiled graph does not match the edge " + edge.from + " -> " + edge.to);
+        }
+        CompiledGraph::AdjacentEdge child = children[out_used[from]++];
+        CompiledGraph::AdjacentEdge parent = parents[in_used[to]++];
+        if (child.node_index != to || child.time_min_ms != edge.time_min_ms || child.time_max_ms != edge.time_max_ms ||
+            parent.node_index != from || parent.time_min_ms != edge.time_min_ms || parent.time_max_ms != edge.time_max_ms) {
+            throw std::invalid_argument("Compiled graph does not match the edge " + edge.from + " -> " + edge.to);
         }
     }
+}
 
-    // REQ-MOD-01: Parse the "edges" array, which defines the causal and temporal relationships between nodes.
-    if (model_data.contains("edges") && model_data["edges"].is_array()) {
-        for (const auto& j_edge : model_data["edges"]) {
-            Edge edge;
-            edge.from = j_edge.at("from").get<std::string>();
-            edge.to = j_edge.at("to").get<std::string>();
-            edge.time_min_ms = j_edge.at("time_min_ms").get<int>();
-            edge.time_max_ms = j_edge.at("time_max_ms").get<int>();
+// Binds an interned ID to a position in a symbol-indexed table. The first definition wins for duplicates.
+static Symbol bindSymbol(std::vector<int>& index, const std::string& id, size_t position) {
+    Symbol symbol = SymbolTable::shared().intern(id);
+    if (symbol >= index.size()) index.resize(static_cast<size_t>(symbol) + 1, -1);
+    if (index[symbol] < 0) index[symbol] = static_cast<int>(position);
+    return symbol;
+}
+
+static int lookupSymbol(const std::vector<int>& index, Symbol symbol) {
+    return symbol < index.size() ? index[symbol] : -1;
+}
+
+// Assigns each node ID its dense index, and each signal ID its position in m_signals.
+void rTFPGModel::rebuildNodeIndex() {
+    m_node_index.assign(m_node_index.size(), -1);
+    m_node_symbols.resize(m_nodes.size());
+    for (size_t i = 0; i < m_nodes.size(); ++i) {
+        m_node_symbols[i] = bindSymbol(m_node_index, m_nodes[i].id, i);
+    }
+    m_signal_index.assign(m_signal_index.size(), -1);
+    for (size_t i = 0; i < m_signals.size(); ++i) {
+        bindSymbol(m_signal_index, m_signals[i].id, i);
+    }
+}
+
+NodeRecord rTFPGModel::makeNodeRecord(const NodeDefinition& node) const {
+    NodeRecord record;
+    record.type = node.type;
+    record.gate_type = node.gate_type.value_or(GateType::OR);
+    record.criticality_level = node.criticality_level;
+    if (node.predicate) {
+        record.has_predicate = true;
+        record.threshold = node.predicate->threshold;
+        record.comparison = node.predicate->comparison;
+        record.signal_index = getSignalIndex(node.predicate->signal_ref);
+    }
+    return record;
+}
+
+void rTFPGModel::storeNodes(std::vector<NodeDefinition>& definitions) {
+    m_nodes.clear();
+    m_nodes.reserve(definitions.size());
+    for (NodeDefinition& definition : definitions) {
+        m_nodes.push_back({std::move(definition.id), std::move(definition.name), std::move(definition.description)});
+    }
+    rebuildNodeIndex(); // The records resolve their signals through it
+    m_node_records.clear();
+    m_node_records.reserve(definitions.size());
+    for (const NodeDefinition& definition : definitions) {
+        m_node_records.push_back(makeNodeRecord(definition));
+    }
+}
+
+NodeDefinition rTFPGModel::getNodeDefinition(size_t index) const {
+    const Node& node = m_nodes.at(index);
+    const NodeRecord& record = m_node_records[index];
+    NodeDefinition definition;
+    definition.id = node.id;
+    definition.name = node.name;
+    definition.description = node.description;
+    definition.type = record.type;
+    definition.criticality_level = record.criticality_level;
+    if (record.type == NodeType::Discrepancy) definition.gate_type = record.gate_type;
+    if (record.has_predicate) {
+        Predicate predicate;
+        if (record.signal_index >= 0) predicate.signal_ref = m_signals[static_cast<size_t>(record.signal_index)].id;
+        predicate.op = comparisonOpSymbol(record.comparison);
+        predicate.threshold = record.threshold;
+        predicate.comparison = record.comparison;
+        definition.predicate = predicate;
+    }
+    return definition;
+}
 
-            m_edges.push_back(edge);
+// Load-time checks of the references the engine relies on (fault_model_schema.md, section 2).
+void rTFPGModel::validate(const std::vector<NodeDefinition>& definitions) const {
+    for (size_t i = 0; i < m_signals.size(); ++i) {
+        if (getSignalIndex(m_signals[i].id) != static_cast<int>(i)) {
+            throw std::invalid_argument("Duplicate signal ID '" + m_signals[i].id + "'");
+        }
+    }
+    for (size_t i = 0; i < m_nodes.size(); ++i) {
+        const std::string& id = m_nodes[i].id;
+        if (getNodeIndex(id) != static_cast<int>(i)) {
+            throw std::invalid_argument("Duplicate node ID '" + id + "'");
+        }
+        if (m_node_records[i].has_predicate && m_node_records[i].signal_index < 0) {
+            throw std::invalid_argument("Node '" + id + "' references unknown signal '" + definitions[i].predicate->signal_ref + "'");
+        }
+    }
+    for (const Edge& edge : m_edges) {
+        const std::string name = "Edge '" + edge.from + "' -> '" + edge.to + "'";
+        if (getNodeIndex(edge.from) < 0) throw std::invalid_argument(name + " references unknown node '" + edge.from + "'");
+        if (getNodeIndex(edge.to) < 0) throw std::invalid_argument(name + " references unknown node '" + edge.to + "'");
+        if (edge.from == edge.to) throw std::invalid_argument(name + " is a self-loop");
+        if (edge.time_min_ms < 0 || edge.time_min_ms > edge.time_max_ms) {
+            throw std::invalid_argument(name + " has an invalid interval [" + std::to_string(edge.time_min_ms) + ", " +
+                                        std::to_string(edge.time_max_ms) + "]");
         }
     }
 }
 
+// Resolves the edge endpoints to node indices and packs them into CSR form.
+void rTFPGModel::compileGraph() const {
+    std::vector<IndexedEdge> resolved;
+    resolved.reserve(m_edges.size());
+    for (const auto& edge : m_edges) {
+        int from = getNodeIndex(edge.from);
+        int to = getNodeIndex(edge.to);
+        if (from < 0 || to < 0) continue;
+        resolved.push_back({static_cast<size_t>(from), static_cast<size_t>(to), edge.time_min_ms, edge.time_max_ms});
+    }
+    m_graph = CompiledGraph(m_nodes.size(), resolved);
+    m_graph_dirty = false;
+}
+
+const CompiledGraph& rTFPGModel::getGraph() const {
+    if (m_graph_dirty) compileGraph();
+    return m_graph;
+}
+
+int rTFPGModel::getNodeIndex(const std::string& id) const {
+    return lookupSymbol(m_node_index, SymbolTable::shared().find(id));
+}
+
+int rTFPGModel::getNodeIndex(Symbol id) const {
+    return lookupSymbol(m_node_index, id);
+}
+
+int rTFPGModel::getSignalIndex(const std::string& id) const {
+    return lookupSymbol(m_signal_index, SymbolTable::shared().find(id));
+}
+
+const CriticalityIndex& rTFPGModel::criticalityIndex() const {
+    if (m_criticality_dirty) {
+        m_criticality = CriticalityIndex(m_node_records, getNodeIdRanks());
+        m_criticality_dirty = false;
+    }
+    return m_criticality;
+}
+
 // REQ-MOD-04: Implementation of GetCriticalityFront
-std::vector<Node> rTFPGModel::GetCriticalityFront(int n) const {
-    std::vector<Node> front;
-    std::copy_if(m_nodes.begin(), m_nodes.end(), std::back_inserter(front),
-                 [n](const Node& node) {
-                     return node.criticality_level >= n;
-                 });
-    return front;
+IndexSpan rTFPGModel::GetCriticalityFront(int n) const {
+    return criticalityIndex().front(n);
 }
 
-void rTFPGModel::addNode(const Node& node) {
-    // Check if node already exists to avoid duplicates
-    for (const auto& n : m_nodes) {
-        if (n.id == node.id) return;
+const BitSet& rTFPGModel::getCriticalityMask(int n) const {
+    return criticalityIndex().mask(n);
+}
+
+const std::vector<uint32_t>& rTFPGModel::getNodeIdRanks() const {
+    if (m_id_ranks_dirty) {
+        std::vector<uint32_t> order(m_nodes.size());
+        for (size_t i = 0; i < order.size(); ++i) order[i] = static_cast<uint32_t>(i);
+        std::sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b) { return m_nodes[a].id < m_nodes[b].id; });
+        m_id_ranks.resize(order.size());
+        for (size_t rank = 0; rank < order.size(); ++rank) m_id_ranks[order[rank]] = static_cast<uint32_t>(rank);
+        m_id_ranks_dirty = false;
     }
-    m_nodes.push_back(node);
+    return m_id_ranks;
+}
+
+static uint64_t edgeKey(Symbol from, Symbol to) {
+    return (static_cast<uint64_t>(from) << 32) | to;
+}
+
+// Indexes every edge by its endpoints. Endpoints are interned even when no such node exists yet,
+// so dangling edges are found once the node is added.
+void rTFPGModel::buildEdgeIndex() {
+    m_edge_links.clear();
+    m_out_edges.clear();
+    m_in_edges.clear();
+    m_edge_multiplicity.clear();
+    m_edge_links.reserve(m_edges.size());
+    m_edge_multiplicity.reserve(m_edges.size());
+    for (size_t i = 0; i < m_edges.size(); ++i) {
+        linkEdge(i);
+    }
+    m_edge_index_built = true;
+}
+
+// Appends the edge at `position` (the last one, or any during buildEdgeIndex) to the indices.
+void rTFPGModel::linkEdge(size_t position) {
+    SymbolTable& symbols = SymbolTable::shared();
+    const Edge& edge = m_edges[position];
+    EdgeLink link{symbols.intern(edge.from), symbols.intern(edge.to), 0, 0};
+
+    size_t needed = static_cast<size_t>(std::max(link.from, link.to)) + 1;
+    if (m_out_edges.size() < needed) {
+        m_out_edges.resize(needed);
+        m_in_edges.resize(needed);
+    }
+    auto& out = m_out_edges[link.from];
+    auto& in = m_in_edges[link.to];
+    link.out_slot = static_cast<uint32_t>(out.size());
+    link.in_slot = static_cast<uint32_t>(in.size());
+    out.push_back(static_cast<uint32_t>(position));
+    in.push_back(static_cast<uint32_t>(position));
+    ++m_edge_multiplicity[edgeKey(link.from, link.to)];
+    m_edge_links.push_back(link);
+}
+
+// Unhooks the edge at `position` from the incident lists and the pair counts. The edge stays in
+// m_edges until eraseEdges() removes it.
+void rTFPGModel::unlinkEdge(size_t position) {
+    const EdgeLink link = m_edge_links[position];
+
+    // Unhook the edge from both incident lists, repointing whichever edge takes over its slot.
+    auto& out = m_out_edges[link.from];
+    uint32_t moved = out.back();
+    out[link.out_slot] = moved;
+    out.pop_back();
+    if (moved != position) m_edge_links[moved].out_slot = link.out_slot;
+
+    auto& in = m_in_edges[link.to];
+    moved = in.back();
+    in[link.in_slot] = moved;
+    in.pop_back();
+    if (moved != position) m_edge_links[moved].in_slot = link.in_slot;
+
+    auto pair = m_edge_multiplicity.find(edgeKey(link.from, link.to));
+    if (--pair->second == 0) m_edge_multiplicity.erase(pair);
+}
+
+// Unlinks and removes the edges at these positions, moving the last edge into each freed slot.
+// Positions are taken in descending order, so the edge moved down is never one still to be removed.
+void rTFPGModel::eraseEdges(std::vector<uint32_t>& positions) {
+    if (positions.empty()) return;
+    std::sort(positions.begin(), positions.end(), std::greater<uint32_t>());
+    positions.erase(std::unique(positions.begin(), positions.end()), positions.end());
+    for (uint32_t position : positions) {
+        unlinkEdge(position);
+        size_t last = m_edges.size() - 1;
+        if (position != last) {
+            m_edges[position] = std::move(m_edges[last]);
+            m_edge_links[position] = m_edge_links[last];
+            const EdgeLink& relocated = m_edge_links[position];
+            m_out_edges[relocated.from][relocated.out_slot] = position;
+            m_in_edges[relocated.to][relocated.in_slot] = position;
+        }
+        m_edges.pop_back();
+        m_edge_links.pop_back();
+    }
+    m_graph_dirty = true;
+}
+
+void rTFPGModel::addNode(const NodeDefinition& node) {
+    // Check if node already exists to avoid duplicates
+    if (getNodeIndex(node.id) >= 0) return;
+    NodeRecord record = makeNodeRecord(node);
+    // Compile the operator of externally built predicates, as the loader does.
+    if (node.predicate) record.comparison = parseComparisonOp(node.predicate->op);
+    m_node_symbols.push_back(bindSymbol(m_node_index, node.id, m_nodes.size()));
+    m_nodes.push_back({node.id, node.name, node.description});
+    m_node_records.push_back(record);
+    m_graph_dirty = true; // Edges that named this node before it existed now resolve
+    m_criticality_dirty = true;
+    m_id_ranks_dirty = true;
 }
 
 void rTFPGModel::removeNode(const std::string& id) {
-    m_nodes.erase(std::remove_if(m_nodes.begin(), m_nodes.end(),
-                                 [&id](const Node& n) { return n.id == id; }),
-                  m_nodes.end());
-    // Also remove connected edges
-    m_edges.erase(std::remove_if(m_edges.begin(), m_edges.end(),
-                                 [&id](const Edge& e) { return e.from == id || e.to == id; }),
-                  m_edges.end());
+    if (!m_edge_index_built) buildEdgeIndex(); // Interns every edge endpoint
+    Symbol symbol = SymbolTable::shared().find(id);
+    if (symbol == kNoSymbol) return;
+
+    // Also remove connected edges.
+    if (symbol < m_out_edges.size()) {
+        std::vector<uint32_t> incident = m_out_edges[symbol];
+        incident.insert(incident.end(), m_in_edges[symbol].begin(), m_in_edges[symbol].end());
+        eraseEdges(incident);
+    }
+
+    int index = getNodeIndex(symbol);
+    if (index < 0) return;
+
+    // Move the last node into the freed index.
+    size_t position = static_cast<size_t>(index);
+    size_t last = m_nodes.size() - 1;
+    m_node_index[symbol] = -1;
+    if (position != last) {
+        Symbol moved = m_node_symbols[last];
+        if (m_node_index[moved] == static_cast<int>(last)) m_node_index[moved] = index;
+        m_nodes[position] = std::move(m_nodes[last]);
+        m_node_records[position] = m_node_records[last];
+        m_node_symbols[position] = moved;
+    }
+    m_nodes.pop_back();
+    m_node_records.pop_back();
+    m_node_symbols.pop_back();
+    m_graph_dirty = true;
+    m_criticality_dirty = true;
+    m_id_ranks_dirty = true;
 }
 
-void rTFPGModel::addEdge(const Edge& edge) {
+bool rTFPGModel::addEdge(const Edge& edge) {
+    if (!m_edge_index_built) buildEdgeIndex();
+    SymbolTable& symbols = SymbolTable::shared();
+    if (m_edge_multiplicity.count(edgeKey(symbols.intern(edge.from), symbols.intern(edge.to)))) return false;
     m_edges.push_back(edge);
+    linkEdge(m_edges.size() - 1);
+    m_graph_dirty = true;
+    return true;
 }
 
 void rTFPGModel::removeEdge(const std::string& from, const std::string& to) {
-    m_edges.erase(std::remove_if(m_edges.begin(), m_edges.end(),
-                                 [&from, &to](const Edge& e) {
-                                     return e.from == from && e.to == to;
-                                 }),
-                  m_edges.end());
+    if (!m_edge_index_built) buildEdgeIndex(); // Interns every edge endpoint
+    SymbolTable& symbols = SymbolTable::shared();
+    Symbol from_symbol = symbols.find(from);
+    Symbol to_symbol = symbols.find(to);
+    if (from_symbol == kNoSymbol || to_symbol == kNoSymbol) return;
+    if (!m_edge_multiplicity.count(edgeKey(from_symbol, to_symbol))) return;
+
+    std::vector<uint32_t> matching;
+    for (uint32_t position : m_out_edges[from_symbol]) {
+        if (m_edge_links[position].to == to_symbol) matching.push_back(position);
+    }
+    eraseEdges(matching);
 }
\ No newline at end of file
@@ -14,7 +14,12 @@
 #include <string>
 #include <vector>
 #include <optional>
+#include <cstdint>
+#include <unordered_map>
 #include "json.hpp"
+#include "CompiledGraph.h"
+#include "CriticalityIndex.h"
+#include "SymbolTable.h"
 
 // Represents a single signal source from the model definition
 struct Signal {
@@ -26,34 +31,81 @@ struct Signal {
     double range_max = 1.0;
 };
 
+// FR-05.1: Comparison operators supported by discrepancy predicates.
+enum class ComparisonOp : uint8_t {
+    Less,         // "<"
+    Greater,      // ">"
+    LessEqual,    // "<="
+    GreaterEqual, // ">="
+    Equal,        // "=="
+    NotEqual      // "!="
+};
+
+/**
+ * @brief Parses a predicate operator string.
+ * @throws std::invalid_argument if the operator is not one of the six FR-05.1 operators.
+ */
+ComparisonOp parseComparisonOp(const std::string& op);
+/// @brief The operator as written in a model file; parseComparisonOp(comparisonOpSymbol(op)) == op.
+const char* comparisonOpSymbol(ComparisonOp op);
+
 // REQ-MOD-02: Discrepancy Predicate (DP)
 struct Predicate {
     std::string signal_ref;
-    std::string op;
+    std::string op;          // Operator as written in the model, kept for reporting
     double threshold;
+    ComparisonOp comparison = ComparisonOp::Greater; // Compiled from op at load time
 };
 
 // REQ-MOD-02: Discrepancy Type (DC)
-enum class GateType {
+enum class GateType : uint8_t {
     OR,
     AND
 };
 
-enum class NodeType {
+enum class NodeType : uint8_t {
     FailureMode,
     Discrepancy
 };
 
-// REQ-MOD-02 & REQ-MOD-03: Node structure for Failure Modes (F) and Discrepancies (D)
-struct Node {
+// REQ-MOD-02 & REQ-MOD-03: A Failure Mode (F) or Discrepancy (D) as written in the model file. This is
+// the form nodes are parsed into and added in; rTFPGModel splits it into a Node and a NodeRecord.
+struct NodeDefinition {
     std::string id;
     std::string name;
+    std::string description; // Optional in the JSON
     NodeType type;
     std::optional<GateType> gate_type; // Only for Discrepancies
     std::optional<Predicate> predicate; // Only for Discrepancies
     int criticality_level = 0; // REQ-MOD-02: Criticality Level (CL)
 };
 
+// The cold part of a stored node: its identity and display strings, read for reporting and lookups.
+struct Node {
+    std::string id;
+    std::string name;
+    std::string description;
+};
+
+/**
+ * @brief The hot part of a stored node: the fields reasoning reads, packed into a fixed-size record.
+ *
+ * rTFPGModel::getNodeRecords() holds one per node at its dense index, so engine and prognosis loops
+ * scan 24 bytes per node (2.4 MB for 100k nodes) and never touch the node's strings. The record is
+ * the only copy of these fields; the predicate's signal and operator strings are recovered from
+ * signal_index and comparison (see rTFPGModel::getNodeDefinition()).
+ */
+struct NodeRecord {
+    double threshold = 0.0;          // Predicate threshold, if has_predicate
+    int32_t criticality_level = 0;
+    int32_t signal_index = -1;       // Position of the predicate's signal in getSignals(), or -1
+    NodeType type = NodeType::FailureMode;
+    GateType gate_type = GateType::OR; // OR unless the node is declared AND
+    ComparisonOp comparison = ComparisonOp::Greater;
+    bool has_predicate = false;
+};
+static_assert(sizeof(NodeRecord) == 24, "NodeRecord is meant to stay one packed 24-byte record");
+
 // REQ-MOD-01: Edge structure (E) with time intervals (ET)
 struct Edge {
     std::string from;
@@ -63,27 +115,175 @@ struct Edge {
     // std::string mode; // Optional operational mode (EM) - not in current JSON
 };
 
+/**
+ * @brief A sub-graph defined once in the model's "templates" array and stamped out by "instances".
+ *
+ * Node IDs and edge endpoints are local to the template. A predicate's signal_ref names a
+ * placeholder that each instance binds to one of the model's signals.
+ */
+struct SubgraphTemplate {
+    std::string id;
+    std::vector<NodeDefinition> nodes;
+    std::vector<Edge> edges;
+};
+
+// One element of the model's "instances" array.
+struct SubgraphInstance {
+    std::string id;          // Qualifies the instance's node IDs and names as "<id>.<local>"
+    std::string template_id;
+    std::unordered_map<std::string, std::string> bindings; // Placeholder -> model signal ID
+};
+
+/**
+ * @brief Parse one element of the model's "signals", "nodes" or "edges" array.
+ * @throws nlohmann::json::exception for missing or mistyped fields, std::invalid_argument for an
+ *         unsupported predicate operator. Shared by the DOM constructor and the streaming ModelLoader.
+ */
+Signal parseSignal(const nlohmann::json& j_signal);
+NodeDefinition parseNode(const nlohmann::json& j_node);
+Edge parseEdge(const nlohmann::json& j_edge);
+/// @brief Parse one element of the "templates" or "instances" array. Throws as the parsers above.
+SubgraphTemplate parseTemplate(const nlohmann::json& j_template);
+SubgraphInstance parseInstance(const nlohmann::json& j_instance);
+
+/**
+ * @brief Appends the nodes and then the edges of every instance, in instance order, to nodes and edges.
+ * @note Each template is checked and indexed once; an instance is then a copy of its already parsed
+ *       nodes and edges with qualified IDs and bound signals, so no JSON is read per instance.
+ * @throws std::invalid_argument for a duplicate template ID, a template edge naming a node outside
+ *         its template, an instance of an unknown template, or a placeholder the instance leaves unbound.
+ */
+void instantiateTemplates(const std::vector<SubgraphTemplate>& templates, const std::vector<SubgraphInstance>& instances,
+                          std::vector<NodeDefinition>& nodes, std::vector<Edge>& edges);
+
 class rTFPGModel {
 public:
+    /**
+     * @throws std::invalid_argument if the model has duplicate signal or node IDs, a predicate naming an
+     *         unknown signal, or an edge naming an unknown node, forming a self-loop, or with an
+     *         interval that is negative or has time_min_ms > time_max_ms.
+     */
     explicit rTFPGModel(const nlohmann::json& model_data);
 
-    // REQ-MOD-04: Returns the set of all nodes with Criticality Level >= n
-    std::vector<Node> GetCriticalityFront(int n) const;
+    /**
+     * @brief REQ-MOD-04: Returns the set of all nodes with Criticality Level >= n.
+     * @return Dense node indices, most critical first (ties in node ID order). A binary search into a
+     *         prebuilt index; valid until the next addNode/removeNode.
+     */
+    IndexSpan GetCriticalityFront(int n) const;
+    /// @brief Membership bit set over dense node indices of GetCriticalityFront(n), for O(1) tests.
+    const BitSet& getCriticalityMask(int n) const;
+
+    /**
+     * @brief Position of each node's ID in lexicographic ID order, by dense node index.
+     * @note Diagnosis ranking and prognosis break exact ties in node ID order; comparing ranks gives that
+     *       order without string compares. Built on first use; valid until the next addNode/removeNode.
+     */
+    const std::vector<uint32_t>& getNodeIdRanks() const;
 
     const std::vector<Signal>& getSignals() const { return m_signals; }
+    /// @brief ID, name and description of every node, by dense node index.
     const std::vector<Node>& getNodes() const { return m_nodes; }
+    /// @brief Type, gate, predicate and criticality of every node, by dense node index.
+    const std::vector<NodeRecord>& getNodeRecords() const { return m_node_records; }
+    /**
+     * @brief Reassembles the definition of the node at this dense index, e.g. to write it out.
+     * @note A predicate on a signal the model does not define (possible through addNode()) is never
+     *       evaluated and comes back with an empty signal_ref.
+     */
+    NodeDefinition getNodeDefinition(size_t index) const;
     const std::vector<Edge>& getEdges() const { return m_edges; }
 
-    // Methods for Graph Refinement
-    void addNode(const Node& node);
+    /**
+     * @brief Gets the dense index of a node, i.e. its position in getNodes().
+     * @return The node index, or -1 if no node has this ID.
+     */
+    int getNodeIndex(const std::string& id) const;
+    /// @brief As above, for an ID already interned in SymbolTable::shared(). No hashing.
+    int getNodeIndex(Symbol id) const;
+
+    /**
+     * @brief Gets the position of a signal in getSignals(). The first definition wins for duplicated IDs.
+     * @return The signal index, or -1 if no signal has this ID.
+     */
+    int getSignalIndex(const std::string& id) const;
+
+    /**
+     * @brief CSR adjacency over dense node indices. After a mutation it is recompiled on the next call.
+     * @note Edges naming an unknown node are left out. References into it are invalidated by mutation.
+     *       Not safe to call concurrently with itself until the first call after a mutation has returned.
+     */
+    const CompiledGraph& getGraph() const;
+
+    /**
+     * Methods for Graph Refinement.
+     *
+     * Mutators use hash indices over node IDs and (from, to) pairs plus per-node incident edge lists,
+     * built on first use. A removal moves the last node or edge into the freed index, so removeNode()
+     * is O(degree) and removeEdge() O(out-degree) wherever the element sits. getNodes() and getEdges()
+     * stay in insertion order until the first removal that is not of the last element; removing the
+     * most recently added one, as try-and-revert loops do, leaves the order of the rest unchanged.
+     * Tie-breaks that must not depend on position use getNodeIdRanks().
+     */
+    /// @brief Adds a node unless one with the same ID exists.
+    void addNode(const NodeDefinition& node);
+    /// @brief Removes the node with this ID (the first one, if the ID is duplicated) and its edges.
     void removeNode(const std::string& id);
-    void addEdge(const Edge& edge);
+    /// @return false if an edge with the same endpoints exists; the model is then unchanged.
+    bool addEdge(const Edge& edge);
+    /// @brief Removes every edge from `from` to `to`.
     void removeEdge(const std::string& from, const std::string& to);
 
 private:
+    friend class ModelSnapshot;
+    friend class ModelLoader;
+    // Builds the indices and graph over already parsed elements.
+    rTFPGModel(std::vector<Signal> signals, std::vector<NodeDefinition> nodes, std::vector<Edge> edges);
+    // Restores a compiled model from a snapshot without rebuilding its adjacency. Validates like the
+    // constructors above, and throws std::invalid_argument if the adjacency does not match the lists.
+    rTFPGModel(std::vector<Signal> signals, std::vector<NodeDefinition> nodes, std::vector<Edge> edges, CompiledGraph graph);
+
     std::vector<Signal> m_signals;
-    std::vector<Node> m_nodes;
+    std::vector<Node> m_nodes;              // Cold: identity and display strings
+    std::vector<NodeRecord> m_node_records; // Hot: parallel to m_nodes
+    std::vector<Symbol> m_node_symbols;     // Parallel to m_nodes: each node's interned ID, for reindexing
     std::vector<Edge> m_edges;
+    /// Interned node ID -> position in m_nodes (or -1), assigned at load and kept in sync by the mutators.
+    std::vector<int> m_node_index;
+    /// Interned signal ID -> position in m_signals (or -1).
+    std::vector<int> m_signal_index;
+    mutable CompiledGraph m_graph;
+    mutable bool m_graph_dirty = false;
+    mutable CriticalityIndex m_criticality;
+    mutable bool m_criticality_dirty = true; // Built on first query, rebuilt after node mutations
+    mutable std::vector<uint32_t> m_id_ranks;
+    mutable bool m_id_ranks_dirty = true;    // Likewise
+
+    // Mutation indices, built by the first mutator call (read-only users never pay for them).
+    struct EdgeLink {
+        Symbol from;
+        Symbol to;
+        uint32_t out_slot; // Position of the edge in m_out_edges[from]
+        uint32_t in_slot;  // Position of the edge in m_in_edges[to]
+    };
+    bool m_edge_index_built = false;
+    std::vector<EdgeLink> m_edge_links;             // Parallel to m_edges
+    std::vector<std::vector<uint32_t>> m_out_edges; // Interned node ID -> positions in m_edges
+    std::vector<std::vector<uint32_t>> m_in_edges;
+    std::unordered_map<uint64_t, uint32_t> m_edge_multiplicity; // (from, to) -> number of such edges
+
+    void rebuildNodeIndex();
+    // Moves the strings of definitions into m_nodes and packs the rest into m_node_records.
+    void storeNodes(std::vector<NodeDefinition>& definitions);
+    NodeRecord makeNodeRecord(const NodeDefinition& node) const;
+    // definitions are those storeNodes() consumed; only their predicates are read, for error messages.
+    void validate(const std::vector<NodeDefinition>& definitions) const;
+    void compileGraph() const;
+    const CriticalityIndex& criticalityIndex() const;
+    void buildEdgeIndex();
+    void linkEdge(size_t position);
+    void unlinkEdge(size_t position);
+    void eraseEdges(std::vector<uint32_t>& positions);
 };
 
 #endif // RTFPG_MODEL_H
\ No newline at end of file